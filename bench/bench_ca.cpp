@@ -0,0 +1,133 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "bench_ioc.h"
+#include "epics/ca/ca_pv.h"
+
+using namespace bchtree::epics::ca;
+using namespace std::chrono_literals;
+using bchtree::bench::RecordName;
+using bchtree::bench::SharedIoc;
+using bchtree::bench::SpinUntil;
+
+namespace {
+
+// Connected channel for round-trip benchmarks
+std::unique_ptr<CAPV> ConnectedPV(std::shared_ptr<CAContextManager> ctx,
+                                  const std::string& name) {
+    auto pv = std::make_unique<CAPV>(std::move(ctx), name);
+    pv->Connect();
+    if (!SpinUntil([&pv] { return pv->IsConnected(); }, 5s)) return nullptr;
+    return pv;
+}
+
+}  // namespace
+
+// Time from ca_create_channel to CONN_UP for N channels whose search
+// requests go out in one flush
+static void BM_CAPV_Connect(benchmark::State& state) {
+    auto ctx = SharedIoc();
+    const size_t n = static_cast<size_t>(state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::atomic<size_t> connected{0};
+        std::vector<std::unique_ptr<CAPV>> pvs;
+        pvs.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            pvs.push_back(std::make_unique<CAPV>(ctx, RecordName(i)));
+            pvs.back()->AddConnCB([&connected](bool up) {
+                if (up) ++connected;
+            });
+        }
+        state.ResumeTiming();
+
+        {
+            IOBatch batch(*ctx);
+            for (auto& pv : pvs) pv->Connect();
+            ctx->RequestFlush();
+        }
+        if (!SpinUntil([&] { return connected.load() == n; }, 10s)) {
+            state.SkipWithError("channels did not connect");
+            break;
+        }
+
+        state.PauseTiming();
+        pvs.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_CAPV_Connect)
+    ->Arg(1)
+    ->Arg(64)
+    ->Arg(bchtree::bench::kRecordCount)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// GetCBAs() issue to callback on a connected scalar channel
+static void BM_CAPV_GetRoundTrip(benchmark::State& state) {
+    auto pv = ConnectedPV(SharedIoc(), RecordName(0));
+    if (!pv) {
+        state.SkipWithError("channel did not connect");
+        return;
+    }
+
+    for (auto _ : state) {
+        std::atomic<bool> done{false};
+        pv->GetCBAs<double>([&done](double) { done = true; }, 1000ms);
+        if (!SpinUntil([&done] { return done.load(); }, 5s)) {
+            state.SkipWithError("get timed out");
+            break;
+        }
+    }
+}
+BENCHMARK(BM_CAPV_GetRoundTrip)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// Same for the full waveform, so decode and copy cost are included
+static void BM_CAPV_GetArrayRoundTrip(benchmark::State& state) {
+    auto pv = ConnectedPV(SharedIoc(), bchtree::bench::kWaveformName);
+    if (!pv) {
+        state.SkipWithError("channel did not connect");
+        return;
+    }
+
+    for (auto _ : state) {
+        std::atomic<bool> done{false};
+        pv->GetCBAs<std::vector<double>>(
+            [&done](std::vector<double>) { done = true; }, 1000ms);
+        if (!SpinUntil([&done] { return done.load(); }, 5s)) {
+            state.SkipWithError("get timed out");
+            break;
+        }
+    }
+}
+BENCHMARK(BM_CAPV_GetArrayRoundTrip)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// PutCB() issue to put completion on a connected scalar channel
+static void BM_CAPV_PutRoundTrip(benchmark::State& state) {
+    auto pv = ConnectedPV(SharedIoc(), RecordName(1));
+    if (!pv) {
+        state.SkipWithError("channel did not connect");
+        return;
+    }
+
+    double value = 0.0;
+    for (auto _ : state) {
+        std::atomic<bool> done{false};
+        pv->PutCB(bchtree::epics::PVScalarValue{value},
+                  [&done](bool) { done = true; });
+        if (!SpinUntil([&done] { return done.load(); }, 5s)) {
+            state.SkipWithError("put timed out");
+            break;
+        }
+        value += 1.0;
+    }
+}
+BENCHMARK(BM_CAPV_PutRoundTrip)->Unit(benchmark::kMicrosecond)->UseRealTime();
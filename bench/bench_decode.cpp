@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "epics/ca/ca_pv.h"
+
+using namespace bchtree::epics::ca;
+
+// Decode of a single value of each DBR type as received by Get/Monitor
+// handlers (TIME_* for plain reads, GR_*/CTRL_* for metadata reads)
+template <chtype Type>
+static void BM_DecodePVScalar(benchmark::State& state) {
+    // dbr_double_t storage keeps the buffer suitably aligned for any DBR
+    std::vector<dbr_double_t> storage(
+        (dbr_size_n(Type, 1) + sizeof(dbr_double_t) - 1) /
+        sizeof(dbr_double_t));
+    std::memset(storage.data(), 0, storage.size() * sizeof(dbr_double_t));
+
+    for (auto _ : state) {
+        auto data = CAPV::DecodePVScalar(Type, storage.data());
+        benchmark::DoNotOptimize(data);
+    }
+}
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_TIME_STRING);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_TIME_SHORT);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_TIME_FLOAT);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_TIME_ENUM);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_TIME_CHAR);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_TIME_LONG);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_TIME_DOUBLE);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_GR_STRING);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_GR_SHORT);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_GR_FLOAT);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_GR_ENUM);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_GR_CHAR);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_GR_LONG);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_GR_DOUBLE);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_CTRL_STRING);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_CTRL_SHORT);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_CTRL_FLOAT);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_CTRL_ENUM);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_CTRL_CHAR);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_CTRL_LONG);
+BENCHMARK_TEMPLATE(BM_DecodePVScalar, DBR_CTRL_DOUBLE);
+
+// Decode of a DBR_TIME_* array with range(0) elements
+template <chtype Type>
+static void BM_DecodePVArray(benchmark::State& state) {
+    const long count = static_cast<long>(state.range(0));
+    // dbr_double_t storage keeps the buffer suitably aligned for any DBR
+    std::vector<dbr_double_t> storage(
+        (dbr_size_n(Type, count) + sizeof(dbr_double_t) - 1) /
+        sizeof(dbr_double_t));
+    std::memset(storage.data(), 0, storage.size() * sizeof(dbr_double_t));
+
+    for (auto _ : state) {
+        auto data = CAPV::DecodePVArray(Type, count, storage.data());
+        benchmark::DoNotOptimize(data);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_DecodePVArray, DBR_TIME_LONG)->Range(16, 16384);
+BENCHMARK_TEMPLATE(BM_DecodePVArray, DBR_TIME_DOUBLE)->Range(16, 16384);
+BENCHMARK_TEMPLATE(BM_DecodePVArray, DBR_TIME_STRING)->Range(16, 1024);
+BENCHMARK_TEMPLATE(BM_DecodePVArray, DBR_TIME_CHAR)->Range(16, 16384);
+
+// Snapshot copy plus typed read, as done by CAPV::GetAs<T>()
+template <typename T>
+static void BM_PVDataCopyAs(benchmark::State& state) {
+    const bchtree::epics::PVData snap =
+        std::is_same_v<T, std::string>
+            ? bchtree::epics::PVData::FromString("a DBR string of 24 chars")
+            : bchtree::epics::PVData::FromDouble(1.25);
+    for (auto _ : state) {
+        bchtree::epics::PVData copy = snap;
+        benchmark::DoNotOptimize(copy);
+        auto value = copy.As<T>();
+        benchmark::DoNotOptimize(value);
+    }
+}
+BENCHMARK_TEMPLATE(BM_PVDataCopyAs, double);
+BENCHMARK_TEMPLATE(BM_PVDataCopyAs, int32_t);
+BENCHMARK_TEMPLATE(BM_PVDataCopyAs, std::string);
@@ -0,0 +1,76 @@
+#include "bench_ioc.h"
+
+#include <stdexcept>
+#include <thread>
+
+#include "epics/ca/ca_pv.h"
+#include "softioc_runner.h"
+
+namespace bchtree::bench {
+
+namespace {
+
+struct Ioc {
+    SoftIocRunner runner;
+    std::shared_ptr<epics::ca::CAContextManager> ctx{
+        std::make_shared<epics::ca::CAContextManager>()};
+
+    Ioc() {
+        // Same loopback-only setup as SoftIocFixture
+        setenv("EPICS_CA_AUTO_ADDR_LIST", "NO", 1);
+        setenv("EPICS_CA_ADDR_LIST", "127.0.0.1", 1);
+        setenv("EPICS_CA_MAX_ARRAY_BYTES", "1048576", 1);
+
+        ctx->EnsureAttached();
+
+        std::string db;
+        for (size_t i = 0; i < kRecordCount; ++i) {
+            db += "record(ao, \"" + RecordName(i) +
+                  "\") {\n"
+                  "    field(VAL,  \"0\")\n"
+                  "    field(PINI, \"YES\")\n"
+                  "}\n";
+        }
+        db += std::string("record(waveform, \"") + kWaveformName +
+              "\") {\n"
+              "    field(FTVL, \"DOUBLE\")\n"
+              "    field(NELM, \"" +
+              std::to_string(kWaveformLength) +
+              "\")\n"
+              "}\n";
+        runner.Start(db);
+
+        // The IOC is ready once the last record can be connected
+        epics::ca::CAPV probe(ctx, RecordName(kRecordCount - 1));
+        probe.Connect();
+        if (!SpinUntil([&probe] { return probe.IsConnected(); },
+                       std::chrono::seconds(10))) {
+            runner.KillIfRunning();
+            throw std::runtime_error("bench: softIoc did not come up");
+        }
+    }
+
+    ~Ioc() { runner.KillIfRunning(); }
+};
+
+}  // namespace
+
+std::string RecordName(size_t i) { return "BENCH:AO" + std::to_string(i); }
+
+std::shared_ptr<epics::ca::CAContextManager> SharedIoc() {
+    static Ioc ioc;
+    ioc.ctx->EnsureAttached();
+    return ioc.ctx;
+}
+
+bool SpinUntil(const std::function<bool()>& pred,
+               std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+}  // namespace bchtree::bench
@@ -0,0 +1,27 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "epics/ca/ca_context_manager.h"
+
+namespace bchtree::bench {
+
+// Records served by the benchmark IOC: kRecordCount ao records named by
+// RecordName(i) and one DOUBLE waveform of kWaveformLength elements.
+constexpr size_t kRecordCount = 1024;
+constexpr size_t kWaveformLength = 1024;
+constexpr const char* kWaveformName = "BENCH:WF";
+
+std::string RecordName(size_t i);
+
+// Start the process-wide softIoc on first use and return a CA context
+// attached to the calling thread. The IOC is stopped at exit.
+std::shared_ptr<epics::ca::CAContextManager> SharedIoc();
+
+// Busy-wait (yielding) until pred() is true; false on timeout.
+bool SpinUntil(const std::function<bool()>& pred,
+               std::chrono::milliseconds timeout);
+
+}  // namespace bchtree::bench
@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "epics/ca/ca_pv_manager.h"
+
+using namespace bchtree::epics::ca;
+
+namespace {
+
+constexpr size_t kPVCount = 4096;
+
+// Shared across benchmark threads; CAPV instances are never connected, so
+// this measures the registry alone.
+struct Registry {
+    std::shared_ptr<CAContextManager> ctx{
+        std::make_shared<CAContextManager>()};
+    PVManager manager{ctx};
+    std::vector<std::string> names;
+    std::vector<size_t> hashes;
+    std::vector<std::shared_ptr<CAPV>> alive;
+
+    Registry() {
+        names.reserve(kPVCount);
+        for (size_t i = 0; i < kPVCount; ++i) {
+            names.push_back("BENCH:PV" + std::to_string(i));
+            hashes.push_back(PVManager::Hash(names.back()));
+            alive.push_back(manager.Get(names.back()));
+        }
+    }
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+}  // namespace
+
+// Get() by name from N threads; each thread walks the names with its own
+// stride so threads hit different shards.
+static void BM_PVManager_Get(benchmark::State& state) {
+    auto& reg = GetRegistry();
+    size_t i = static_cast<size_t>(state.thread_index()) * 7919;
+    for (auto _ : state) {
+        auto pv = reg.manager.Get(reg.names[i % kPVCount]);
+        benchmark::DoNotOptimize(pv);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PVManager_Get)->ThreadRange(1, 16)->UseRealTime();
+
+// Same as above with the hash computed up front
+static void BM_PVManager_GetPrehashed(benchmark::State& state) {
+    auto& reg = GetRegistry();
+    size_t i = static_cast<size_t>(state.thread_index()) * 7919;
+    for (auto _ : state) {
+        const size_t k = i % kPVCount;
+        auto pv = reg.manager.Get(reg.names[k], reg.hashes[k]);
+        benchmark::DoNotOptimize(pv);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PVManager_GetPrehashed)->ThreadRange(1, 16)->UseRealTime();
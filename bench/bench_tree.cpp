@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "bench_ioc.h"
+#include "bt_runner.h"
+#include "epics/ca/ca_pv_manager.h"
+
+using namespace bchtree;
+using bchtree::bench::RecordName;
+
+namespace {
+
+// Sequence of n CAPutDouble/CAGetDouble pairs on distinct records
+std::string MakeTreeXml(size_t n) {
+    std::string xml =
+        "<root BTCPP_format=\"4\">\n"
+        "  <BehaviorTree ID=\"MainTree\">\n"
+        "    <Sequence>\n";
+    for (size_t i = 0; i < n; ++i) {
+        const std::string pv = RecordName(i % bench::kRecordCount);
+        xml += "      <CAPutDouble pv=\"" + pv + "\" value=\"" +
+               std::to_string(i) + "\" timeout=\"1000\"/>\n";
+        xml += "      <CAGetDouble pv=\"" + pv +
+               "\" timeout=\"1000\" result=\"{v}\"/>\n";
+    }
+    xml +=
+        "    </Sequence>\n"
+        "  </BehaviorTree>\n"
+        "</root>\n";
+    return xml;
+}
+
+std::filesystem::path WriteTree(size_t n) {
+    const auto path = std::filesystem::temp_directory_path() /
+                      ("bch-bench-tree-" + std::to_string(n) + ".xml");
+    std::ofstream ofs(path);
+    ofs << MakeTreeXml(n);
+    return path;
+}
+
+}  // namespace
+
+// One full Run() of a tree with range(0) put/get pairs. range(1) selects
+// the tick mode (0: poll, 1: event).
+static void BM_Tree_PutGetSequence(benchmark::State& state) {
+    auto ctx = bench::SharedIoc();
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto path = WriteTree(n);
+
+    BTRunner runner(ctx, std::make_shared<epics::ca::PVManager>(ctx));
+    if (state.range(1) == 1) {
+        runner.SetTickMode(TickMode::kEvent);
+    }
+    // Keep channel connection out of the measured runs
+    runner.SetPrewarmWait(1.0, std::chrono::seconds(10));
+    runner.RegisterTreeFromFile(path.string());
+
+    for (auto _ : state) {
+        if (!runner.Run(std::chrono::milliseconds(1))) {
+            state.SkipWithError("tree failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+BENCHMARK(BM_Tree_PutGetSequence)
+    ->ArgsProduct({{1, 16, 256}, {0, 1}})
+    ->ArgNames({"pairs", "event"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -1,8 +1,10 @@
 #pragma once
 #include <behaviortree_cpp/behavior_tree.h>
 
+#include "actions/monitor_port.h"
 #include "epics/ca/ca_pv.h"
 #include "epics/ca/ca_pv_manager.h"
+#include "epics/ca/pv_handle.h"
 #include "epics/types.h"
 
 namespace bchtree {
@@ -17,8 +19,26 @@ class CAGetNode : public BT::StatefulActionNode {
                        std::shared_ptr<epics::ca::PVManager> pv_manager)
         : BT::StatefulActionNode(name, cfg),
           ctx_(ctx),
-          pv_manager_(pv_manager) {
+          pv_manager_(pv_manager),
+          pv_(pv_manager_,
+              [this](bool connected) { handleConnection(connected); },
+              [this]() { handleMonitor(); }) {
         ctx_->EnsureAttached();
+        ApplyMonitorPort(cfg, pv_);
+
+        // Literal pv ports are resolved once here; remapped ones in onStart
+        static_pv_ = ResolveLiteralPort(cfg, "pv", pv_);
+
+        // Property outputs, and enum state strings for string results,
+        // need the channel's cached DBR_CTRL_* info
+        for (const char* port :
+             {"units", "precision", "ctrl_low", "ctrl_high", "enum_strings"}) {
+            auto out = cfg.output_ports.find(port);
+            if (out != cfg.output_ports.end() && !out->second.empty()) {
+                wants_info_ = true;
+            }
+        }
+        needs_info_ = wants_info_ || std::is_same_v<T, std::string>;
     }
 
     // Ports definition for BehaviorTree.CPP
@@ -26,36 +46,45 @@ class CAGetNode : public BT::StatefulActionNode {
         using namespace BT;
         return {
             InputPort<std::string>("pv"),
+            InputPort<std::string>("monitor"),
             InputPort<int>("timeout"),
             InputPort<bool>("use_monitor"),
             OutputPort<T>("result"),
+            OutputPort<std::string>("units"),
+            OutputPort<int>("precision"),
+            OutputPort<double>("ctrl_low"),
+            OutputPort<double>("ctrl_high"),
+            OutputPort<std::vector<std::string>>("enum_strings"),
         };
     }
 
     // Lifecycle
     BT::NodeStatus onStart() override {
+        // Retires the previous execution's get before the flags are
+        // cleared, so its late reply cannot pass for this one's
+        ++request_seq_;
         cancelled_ = false;
         done_ = false;
+        failed_ = false;
         requested_ = false;
 
-        if (!BT::TreeNode::getInput("pv", pv_name_)) {
-            throw BT::RuntimeError("CAGetNode: missing required input [pv]");
+        if (!static_pv_) {
+            // Re-resolves only if the blackboard value changed
+            auto pv_name = BT::TreeNode::getInput<std::string>("pv");
+            if (!pv_name) {
+                throw BT::RuntimeError(
+                    "CAGetNode: missing required input [pv]");
+            }
+            pv_.Resolve(pv_name.value());
         }
         BT::TreeNode::getInput("timeout", timeout_ms_);
         BT::TreeNode::getInput("use_monitor", use_monitor_);
-
-        promise_ = std::promise<T>();
-        future_ = promise_.get_future();
+        // Falls back to a get when the channel's monitor policy is off
+        if (use_monitor_ && !pv_->RequestMonitor()) use_monitor_ = false;
 
         deadline_ = std::chrono::steady_clock::now() +
                     std::chrono::milliseconds(timeout_ms_);
 
-        if (!pv_) {
-            pv_ = pv_manager_->Get(pv_name_);
-            pv_->AddConnCB(
-                [this](bool connected) { handleConnection(connected); });
-        }
-
         connected_ = pv_->IsConnected();
 
         if (!connected_) {
@@ -65,50 +94,34 @@ class CAGetNode : public BT::StatefulActionNode {
 
         // Use monitor value
         if (use_monitor_) {
-            T sample = pv_->GetAs<T>();
-            setOutput("result", sample);
-            return BT::NodeStatus::SUCCESS;
+            if (!pv_->HasValue() || !infoReady()) {
+                // Woken up by handleMonitor() on the first update
+                return BT::NodeStatus::RUNNING;
+            }
+            return finish(pv_->GetAs<T>());
         }
 
-        // Issue getCB
-        bool status =
-            pv_->GetCBAs<T>([this](T sample) { handleGetResult(sample); },
-                            std::chrono::milliseconds(timeout_ms_));
-        if (!status) {
-            throw BT::RuntimeError("CAGetNode: failed to call getCB");
-        }
-        requested_ = true;
+        // The get reply is converted on arrival, so wait for enum strings
+        if (infoReady()) issueGet();
 
         return BT::NodeStatus::RUNNING;
     }
 
     BT::NodeStatus onRunning() override {
-        if (use_monitor_ && connected_) {
-            T sample = pv_->GetAs<T>();
-            setOutput("result", sample);
-            return BT::NodeStatus::SUCCESS;
+        if (use_monitor_ && connected_ && pv_->HasValue() && infoReady()) {
+            return finish(pv_->GetAs<T>());
         }
 
-        if (!requested_ && connected_) {
-            // Issue get
-            bool status =
-                pv_->GetCBAs<T>([this](T sample) { handleGetResult(sample); },
-                                std::chrono::milliseconds(timeout_ms_));
-            if (!status) {
-                throw BT::RuntimeError("CAGetNode: failed to call getCB");
-            }
-            requested_ = true;
+        if (!requested_ && connected_ && infoReady()) {
+            issueGet();
         }
 
         // Check condition
         if (done_) {
-            try {
-                auto samp = future_.get();
-                setOutput("result", samp);
-                return BT::NodeStatus::SUCCESS;
-            } catch (...) {
-                return BT::NodeStatus::FAILURE;
-            }
+            return finish(result_);
+        }
+        if (failed_) {
+            throw BT::RuntimeError("CAGetNode: ", pv_.Name(), ": ", error_);
         }
 
         // timeout
@@ -123,27 +136,80 @@ class CAGetNode : public BT::StatefulActionNode {
 
     void onHalted() override { cancelled_ = true; }
 
-    // Non-copyable / movable: node owns async state (promise/future) and EPICS
+    // Non-copyable / movable: node owns async state (result slot) and EPICS
     CAGetNode(const CAGetNode&) = delete;
     CAGetNode& operator=(const CAGetNode&) = delete;
     CAGetNode(CAGetNode&&) noexcept = default;
     CAGetNode& operator=(CAGetNode&&) noexcept = default;
 
    private:
-    void handleGetResult(T sample) {
-        if (cancelled_) {
+    bool infoReady() const { return !needs_info_ || pv_->ControlInfo(); }
+
+    BT::NodeStatus finish(const T& sample) {
+        setOutput("result", sample);
+        if (wants_info_) {
+            const auto info = pv_->ControlInfo();
+            setOutput("units", info->units);
+            setOutput("precision", static_cast<int>(info->precision));
+            setOutput("ctrl_low", info->control_low);
+            setOutput("ctrl_high", info->control_high);
+            setOutput("enum_strings", info->enum_strings);
+        }
+        return BT::NodeStatus::SUCCESS;
+    }
+
+    void issueGet() {
+        // Captures stay within std::function's inline buffer, so together
+        // with CAPV's pooled request contexts a get does not allocate
+        const uint64_t seq = ++request_seq_;
+        bool status = pv_.GetCBAs<T>(
+            [this, seq](T sample) { handleGetResult(seq, std::move(sample)); },
+            std::chrono::milliseconds(timeout_ms_),
+            [this, seq](const std::string& error) {
+                handleGetError(seq, error);
+            });
+        if (!status) {
+            throw BT::RuntimeError("CAGetNode: failed to call getCB");
+        }
+        requested_ = true;
+    }
+
+    void handleGetResult(uint64_t seq, T sample) {
+        // Drop replies to requests from a halted or timed-out execution
+        if (cancelled_ || seq != request_seq_) {
             return;
         }
 
-        promise_.set_value(sample);
+        result_ = std::move(sample);
         done_ = true;
         emitWakeUpSignal();
     }
 
-    void handleConnection(bool connected) { connected_ = connected; }
+    void handleGetError(uint64_t seq, const std::string& error) {
+        if (cancelled_ || seq != request_seq_) {
+            return;
+        }
+
+        error_ = error;
+        failed_ = true;
+        emitWakeUpSignal();
+    }
+
+    void handleConnection(bool connected) {
+        connected_ = connected;
+        if (connected) {
+            emitWakeUpSignal();
+        }
+    }
+
+    void handleMonitor() {
+        // Only a RUNNING node can be waiting for the first monitor update
+        // or the channel properties
+        if (status() == BT::NodeStatus::RUNNING) {
+            emitWakeUpSignal();
+        }
+    }
 
-    // EPICS CA PV handle
-    std::shared_ptr<epics::ca::CAPV> pv_;
     std::shared_ptr<epics::ca::CAContextManager> ctx_;
     std::shared_ptr<epics::ca::PVManager> pv_manager_;
 
@@ -152,19 +218,29 @@ class CAGetNode : public BT::StatefulActionNode {
     std::atomic<bool> done_{false};
     std::atomic<bool> cancelled_{false};
     std::atomic<bool> connected_{false};
+    std::atomic<bool> failed_{false};
 
-    // Result delivery: promise/future shared to allow repeated polls in
-    // onRunning()
-    std::promise<T> promise_;
-    std::shared_future<T> future_;
+    // Result delivery: written by the CA thread before done_ (failed_) is
+    // set, read in onRunning() after it is observed
+    T result_{};
+    std::string error_;
+    // Identifies the outstanding get so stale replies are ignored; bumped
+    // on every start and every get
+    std::atomic<uint64_t> request_seq_{0};
 
     // Inputs (immutable during a single tick execution)
-    std::string pv_name_;
+    bool static_pv_{false};
     int timeout_ms_{kDefaultTimeoutMs};  // >= 0
     bool use_monitor_{true};
+    // Set from the connected ports in the constructor
+    bool wants_info_{false};
+    bool needs_info_{false};
 
     // Deadline for the current execution (set in onStart)
     std::chrono::steady_clock::time_point deadline_{};
+
+    // EPICS CA PV handle
+    epics::ca::PVHandle pv_;
 };
 
 }  // namespace bchtree
@@ -0,0 +1,351 @@
+#pragma once
+#include <behaviortree_cpp/behavior_tree.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "actions/monitor_port.h"
+#include "epics/ca/ca_pv.h"
+#include "epics/ca/ca_pv_manager.h"
+#include "epics/ca/pv_group.h"
+#include "epics/types.h"
+
+namespace bchtree {
+
+// PV list ports shared by CAGetMulti and CAPutMulti. Either
+//   pvs="A;B;C"  or  pattern="MAG:PS{}:CUR" range="1..50"
+inline BT::PortsList MultiPVPorts() {
+    using namespace BT;
+    return {
+        InputPort<std::vector<std::string>>("pvs"),
+        InputPort<std::string>("pattern"),
+        InputPort<std::string>("range"),
+        InputPort<int>("timeout"),
+    };
+}
+
+// Names from the ports above; literal_only skips remapped ports (used to
+// resolve at construction) and returns an empty list if any is remapped.
+inline std::vector<std::string> ReadMultiPVNames(const BT::TreeNode& node,
+                                                 const BT::NodeConfig& cfg,
+                                                 bool literal_only) {
+    std::string pvs;
+    std::string pattern;
+    std::string range;
+    if (literal_only) {
+        if (LiteralPort(cfg, "pvs", pvs)) {
+            return BT::convertFromString<std::vector<std::string>>(pvs);
+        }
+        if (LiteralPort(cfg, "pattern", pattern) &&
+            LiteralPort(cfg, "range", range)) {
+            return epics::ca::PVGroup::ExpandPattern(pattern, range);
+        }
+        return {};
+    }
+
+    if (auto list = node.getInput<std::vector<std::string>>("pvs")) {
+        return list.value();
+    }
+    if (node.getInput("pattern", pattern) && node.getInput("range", range)) {
+        return epics::ca::PVGroup::ExpandPattern(pattern, range);
+    }
+    throw BT::RuntimeError(node.registrationName(),
+                           ": requires [pvs] or [pattern] and [range]");
+}
+
+// Gets every PV in one flush and outputs the values (in PV order) once all
+// have arrived. One timeout covers the whole set.
+template <typename T>
+class CAGetMultiNode : public BT::StatefulActionNode {
+   public:
+    static constexpr int kDefaultTimeoutMs = 1000;
+
+    explicit CAGetMultiNode(const std::string& name, const BT::NodeConfig& cfg,
+                            std::shared_ptr<epics::ca::CAContextManager> ctx,
+                            std::shared_ptr<epics::ca::PVManager> pv_manager)
+        : BT::StatefulActionNode(name, cfg),
+          ctx_(ctx),
+          pv_manager_(pv_manager),
+          pvs_(pv_manager_,
+               [this](bool connected) { handleConnection(connected); }) {
+        ctx_->EnsureAttached();
+
+        const auto names = ReadMultiPVNames(*this, cfg, true);
+        if (!names.empty()) {
+            pvs_.Resolve(names);
+            static_pvs_ = true;
+        }
+    }
+
+    ~CAGetMultiNode() override { cancel(); }
+
+    static BT::PortsList providedPorts() {
+        auto ports = MultiPVPorts();
+        ports.insert(BT::OutputPort<std::vector<T>>("result"));
+        return ports;
+    }
+
+    BT::NodeStatus onStart() override {
+        if (!static_pvs_) {
+            pvs_.Resolve(ReadMultiPVNames(*this, config(), false));
+        }
+        timeout_ms_ = kDefaultTimeoutMs;
+        BT::TreeNode::getInput("timeout", timeout_ms_);
+        deadline_ = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(timeout_ms_);
+        state_.reset();
+
+        return onRunning();
+    }
+
+    BT::NodeStatus onRunning() override {
+        if (!state_ && pvs_.ConnectAll()) {
+            issue();
+        }
+
+        if (state_ && state_->remaining == 0) {
+            setOutput("result", std::move(state_->values));
+            state_.reset();
+            return BT::NodeStatus::SUCCESS;
+        }
+        if (state_) {
+            std::string error;
+            {
+                std::lock_guard<std::mutex> lock(state_->mtx);
+                if (!state_->error.empty()) {
+                    error = pvs_.Name(state_->error_pv) + ": " + state_->error;
+                }
+            }
+            if (!error.empty()) {
+                cancel();
+                throw BT::RuntimeError("CAGetMultiNode: ", error);
+            }
+        }
+
+        if (std::chrono::steady_clock::now() > deadline_) {
+            cancel();
+            return BT::NodeStatus::FAILURE;
+        }
+        return BT::NodeStatus::RUNNING;
+    }
+
+    void onHalted() override { cancel(); }
+
+    CAGetMultiNode(const CAGetMultiNode&) = delete;
+    CAGetMultiNode& operator=(const CAGetMultiNode&) = delete;
+
+   private:
+    // Shared with in-flight callbacks, which may outlive one execution or
+    // the node. Callbacks hold mtx while they touch the node, and cancel()
+    // takes it, so none is still running once the node is destroyed.
+    struct State {
+        std::mutex mtx;
+        bool cancelled{false};
+        std::vector<T> values;
+        std::atomic<size_t> remaining{0};
+        // First failed get and the index of its PV
+        std::string error;
+        size_t error_pv{0};
+    };
+
+    void issue() {
+        auto state = std::make_shared<State>();
+        state->values.resize(pvs_.Size());
+        state->remaining = pvs_.Size();
+
+        // All requests leave in a single ca_flush_io()
+        epics::ca::IOBatch batch(*ctx_);
+        for (size_t i = 0; i < pvs_.Size(); ++i) {
+            const bool ok = pvs_[i].GetCBAs<T>(
+                [this, state, i](T sample) {
+                    std::lock_guard<std::mutex> lock(state->mtx);
+                    if (state->cancelled) return;
+                    state->values[i] = std::move(sample);
+                    if (--state->remaining == 0) emitWakeUpSignal();
+                },
+                std::chrono::milliseconds(timeout_ms_), nullptr,
+                [this, state, i](const std::string& error) {
+                    std::lock_guard<std::mutex> lock(state->mtx);
+                    if (state->cancelled || !state->error.empty()) return;
+                    state->error = error;
+                    state->error_pv = i;
+                    emitWakeUpSignal();
+                });
+            if (!ok) {
+                state_ = std::move(state);
+                cancel();
+                throw BT::RuntimeError("CAGetMultiNode: failed to get ",
+                                       pvs_.Name(i));
+            }
+        }
+        state_ = std::move(state);
+    }
+
+    void cancel() {
+        if (state_) {
+            std::lock_guard<std::mutex> lock(state_->mtx);
+            state_->cancelled = true;
+        }
+        state_.reset();
+    }
+
+    void handleConnection(bool connected) {
+        if (connected && status() == BT::NodeStatus::RUNNING) {
+            emitWakeUpSignal();
+        }
+    }
+
+    std::shared_ptr<epics::ca::CAContextManager> ctx_;
+    std::shared_ptr<epics::ca::PVManager> pv_manager_;
+
+    std::shared_ptr<State> state_;
+    bool static_pvs_{false};
+    int timeout_ms_{kDefaultTimeoutMs};
+    std::chrono::steady_clock::time_point deadline_{};
+
+    // EPICS CA PV handles
+    epics::ca::PVGroup pvs_;
+};
+
+// Puts one value per PV (or one value to all PVs) in one flush and succeeds
+// once every put has completed successfully.
+template <typename T>
+class CAPutMultiNode : public BT::StatefulActionNode {
+   public:
+    static constexpr int kDefaultTimeoutMs = 1000;
+
+    explicit CAPutMultiNode(const std::string& name, const BT::NodeConfig& cfg,
+                            std::shared_ptr<epics::ca::CAContextManager> ctx,
+                            std::shared_ptr<epics::ca::PVManager> pv_manager)
+        : BT::StatefulActionNode(name, cfg),
+          ctx_(ctx),
+          pv_manager_(pv_manager),
+          pvs_(pv_manager_,
+               [this](bool connected) { handleConnection(connected); }) {
+        ctx_->EnsureAttached();
+
+        const auto names = ReadMultiPVNames(*this, cfg, true);
+        if (!names.empty()) {
+            pvs_.Resolve(names);
+            static_pvs_ = true;
+        }
+    }
+
+    ~CAPutMultiNode() override { cancel(); }
+
+    static BT::PortsList providedPorts() {
+        auto ports = MultiPVPorts();
+        ports.insert(BT::InputPort<std::vector<T>>("values"));
+        return ports;
+    }
+
+    BT::NodeStatus onStart() override {
+        if (!static_pvs_) {
+            pvs_.Resolve(ReadMultiPVNames(*this, config(), false));
+        }
+        if (!BT::TreeNode::getInput("values", values_)) {
+            throw BT::RuntimeError(
+                "CAPutMultiNode: missing required input [values]");
+        }
+        if (values_.size() != 1 && values_.size() != pvs_.Size()) {
+            throw BT::RuntimeError("CAPutMultiNode: ", values_.size(),
+                                   " values for ", pvs_.Size(), " PVs");
+        }
+        timeout_ms_ = kDefaultTimeoutMs;
+        BT::TreeNode::getInput("timeout", timeout_ms_);
+        deadline_ = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(timeout_ms_);
+        state_.reset();
+
+        return onRunning();
+    }
+
+    BT::NodeStatus onRunning() override {
+        if (!state_ && pvs_.ConnectAll()) {
+            issue();
+        }
+
+        if (state_ && state_->remaining == 0) {
+            const bool ok = !state_->failed;
+            state_.reset();
+            return ok ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
+        }
+
+        if (std::chrono::steady_clock::now() > deadline_) {
+            cancel();
+            return BT::NodeStatus::FAILURE;
+        }
+        return BT::NodeStatus::RUNNING;
+    }
+
+    void onHalted() override { cancel(); }
+
+    CAPutMultiNode(const CAPutMultiNode&) = delete;
+    CAPutMultiNode& operator=(const CAPutMultiNode&) = delete;
+
+   private:
+    // See CAGetMultiNode::State
+    struct State {
+        std::mutex mtx;
+        bool cancelled{false};
+        std::atomic<size_t> remaining{0};
+        std::atomic<bool> failed{false};
+    };
+
+    void issue() {
+        auto state = std::make_shared<State>();
+        state->remaining = pvs_.Size();
+
+        // All requests leave in a single ca_flush_io()
+        epics::ca::IOBatch batch(*ctx_);
+        for (size_t i = 0; i < pvs_.Size(); ++i) {
+            const T& value = values_[values_.size() == 1 ? 0 : i];
+            const bool ok = pvs_[i].PutCB(
+                epics::PVScalarValue{value}, [this, state](bool success) {
+                    std::lock_guard<std::mutex> lock(state->mtx);
+                    if (state->cancelled) return;
+                    if (!success) state->failed = true;
+                    if (--state->remaining == 0) emitWakeUpSignal();
+                });
+            if (!ok) {
+                state_ = std::move(state);
+                cancel();
+                throw BT::RuntimeError("CAPutMultiNode: failed to put ",
+                                       pvs_.Name(i));
+            }
+        }
+        state_ = std::move(state);
+    }
+
+    void cancel() {
+        if (state_) {
+            std::lock_guard<std::mutex> lock(state_->mtx);
+            state_->cancelled = true;
+        }
+        state_.reset();
+    }
+
+    void handleConnection(bool connected) {
+        if (connected && status() == BT::NodeStatus::RUNNING) {
+            emitWakeUpSignal();
+        }
+    }
+
+    std::shared_ptr<epics::ca::CAContextManager> ctx_;
+    std::shared_ptr<epics::ca::PVManager> pv_manager_;
+
+    std::shared_ptr<State> state_;
+    std::vector<T> values_;
+    bool static_pvs_{false};
+    int timeout_ms_{kDefaultTimeoutMs};
+    std::chrono::steady_clock::time_point deadline_{};
+
+    // EPICS CA PV handles
+    epics::ca::PVGroup pvs_;
+};
+
+}  // namespace bchtree
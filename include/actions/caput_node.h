@@ -1,8 +1,12 @@
 #pragma once
 #include <behaviortree_cpp/behavior_tree.h>
 
+#include <algorithm>
+
+#include "actions/monitor_port.h"
 #include "epics/ca/ca_pv.h"
 #include "epics/ca/ca_pv_manager.h"
+#include "epics/ca/pv_handle.h"
 #include "epics/types.h"
 
 namespace bchtree {
@@ -17,8 +21,15 @@ class CAPutNode : public BT::StatefulActionNode {
                        std::shared_ptr<epics::ca::PVManager> pv_manager)
         : BT::StatefulActionNode(name, cfg),
           ctx_(ctx),
-          pv_manager_(pv_manager) {
+          pv_manager_(pv_manager),
+          pv_(pv_manager_,
+              [this](bool connected) { handleConnection(connected); },
+              [this]() { handleMonitor(); }) {
         ctx_->EnsureAttached();
+        ApplyMonitorPort(cfg, pv_);
+
+        // Literal pv ports are resolved once here; remapped ones in onStart
+        static_pv_ = ResolveLiteralPort(cfg, "pv", pv_);
     }
 
     // Ports definition for BehaviorTree.CPP
@@ -26,9 +37,11 @@ class CAPutNode : public BT::StatefulActionNode {
         using namespace BT;
         return {
             InputPort<std::string>("pv"),
+            InputPort<std::string>("monitor"),
             InputPort<T>("value"),
             InputPort<int>("timeout"),
             InputPort<bool>("force_write"),
+            InputPort<bool>("check_limits"),
         };
     }
 
@@ -38,24 +51,27 @@ class CAPutNode : public BT::StatefulActionNode {
         done_ = false;
         requested_ = false;
 
-        if (!BT::TreeNode::getInput("pv", pv_name_)) {
-            throw BT::RuntimeError("CAPutNode: missing required input [pv]");
+        if (!static_pv_) {
+            // Re-resolves only if the blackboard value changed
+            auto pv_name = BT::TreeNode::getInput<std::string>("pv");
+            if (!pv_name) {
+                throw BT::RuntimeError(
+                    "CAPutNode: missing required input [pv]");
+            }
+            pv_.Resolve(pv_name.value());
         }
         if (!BT::TreeNode::getInput("value", value_)) {
             throw BT::RuntimeError("CAPutNode: missing required input [value]");
         }
         BT::TreeNode::getInput("timeout", timeout_ms_);
         BT::TreeNode::getInput("force_write", force_write_);
+        BT::TreeNode::getInput("check_limits", check_limits_);
+        // Skipping an equal write needs monitor data; without it, write
+        compare_ = !force_write_ && pv_->RequestMonitor();
 
         deadline_ = std::chrono::steady_clock::now() +
                     std::chrono::milliseconds(timeout_ms_);
 
-        if (!pv_) {
-            pv_ = pv_manager_->Get(pv_name_);
-            pv_->AddConnCB(
-                [this](bool connected) { handleConnection(connected); });
-        }
-
         connected_ = pv_->IsConnected();
 
         if (!connected_) {
@@ -63,33 +79,13 @@ class CAPutNode : public BT::StatefulActionNode {
             return BT::NodeStatus::RUNNING;
         }
 
-        if (!force_write_) {
-            T current_val = pv_->GetAs<T>();
-            if (value_ == current_val) {
-                return BT::NodeStatus::SUCCESS;
-            }
-        }
-
-        // Issue put
-        bool status = pv_->PutCB(
-            value_, [this](bool success) { handlePutResult(success); });
-        if (!status) {
-            throw BT::RuntimeError("CAPutNode: failed to call PutCB");
-        }
-        requested_ = true;
-
-        return BT::NodeStatus::RUNNING;
+        return startPut();
     }
 
     BT::NodeStatus onRunning() override {
         if (!requested_ && connected_) {
-            // Issue put
-            bool status = pv_->PutCB(
-                value_, [this](bool success) { handlePutResult(success); });
-            if (!status) {
-                throw BT::RuntimeError("CAPutNode: failed to call PutCB");
-            }
-            requested_ = true;
+            const BT::NodeStatus st = startPut();
+            if (st != BT::NodeStatus::RUNNING) return st;
         }
 
         // Check condition
@@ -116,6 +112,66 @@ class CAPutNode : public BT::StatefulActionNode {
     CAPutNode& operator=(CAPutNode&&) noexcept = default;
 
    private:
+    // Validates and compares the value, then issues the put. RUNNING
+    // without a request while the channel properties are not known yet.
+    BT::NodeStatus startPut() {
+        if (check_limits_) {
+            const auto info = pv_->ControlInfo();
+            if (!info) {
+                // Woken up by handleMonitor() when they arrive
+                return BT::NodeStatus::RUNNING;
+            }
+            if (!withinLimits(*info)) {
+                if (Logger* logger = ctx_->GetLogger()) {
+                    logger->warn(pv_.Name() + ": value outside DRVL/DRVH [" +
+                                 std::to_string(info->control_low) + ", " +
+                                 std::to_string(info->control_high) + "]");
+                }
+                return BT::NodeStatus::FAILURE;
+            }
+        }
+
+        if (compare_ && pv_->HasValue()) {
+            T current_val = pv_->GetAs<T>();
+            if (value_ == current_val) {
+                return BT::NodeStatus::SUCCESS;
+            }
+        }
+
+        // Issue put
+        bool status = pv_.PutCB(
+            value_, [this](bool success) { handlePutResult(success); });
+        if (!status) {
+            throw BT::RuntimeError("CAPutNode: failed to call PutCB");
+        }
+        requested_ = true;
+
+        return BT::NodeStatus::RUNNING;
+    }
+
+    // Numbers must lie within the control limits (if the record sets
+    // any), strings written to an enum PV must name one of its states
+    bool withinLimits(const epics::PVControlInfo& info) const {
+        if constexpr (std::is_arithmetic_v<T>) {
+            return info.WithinControlLimits(static_cast<double>(value_));
+        } else if constexpr (epics::is_vector_v<T>) {
+            using E = typename T::value_type;
+            if constexpr (std::is_arithmetic_v<E>) {
+                return std::all_of(value_.begin(), value_.end(),
+                                   [&info](E v) {
+                                       return info.WithinControlLimits(
+                                           static_cast<double>(v));
+                                   });
+            }
+            return true;
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            return info.enum_strings.empty() ||
+                   info.EnumIndex(value_).has_value();
+        } else {
+            return true;
+        }
+    }
+
     void handlePutResult(bool success) {
         if (cancelled_) {
             return;
@@ -125,10 +181,20 @@ class CAPutNode : public BT::StatefulActionNode {
         emitWakeUpSignal();
     }
 
-    void handleConnection(bool connected) { connected_ = connected; }
+    void handleConnection(bool connected) {
+        connected_ = connected;
+        if (connected) {
+            emitWakeUpSignal();
+        }
+    }
+
+    void handleMonitor() {
+        // Only waits for the channel properties before the put is issued
+        if (status() == BT::NodeStatus::RUNNING && !requested_) {
+            emitWakeUpSignal();
+        }
+    }
 
-    // EPICS CA PV handle
-    std::shared_ptr<epics::ca::CAPV> pv_;
     std::shared_ptr<epics::ca::CAContextManager> ctx_;
     std::shared_ptr<epics::ca::PVManager> pv_manager_;
 
@@ -139,13 +205,18 @@ class CAPutNode : public BT::StatefulActionNode {
     std::atomic<bool> connected_{false};
 
     // Inputs (immutable during a single tick execution)
-    std::string pv_name_;
+    bool static_pv_{false};
     int timeout_ms_{kDefaultTimeoutMs};  // >= 0
     T value_;
     bool force_write_{false};
+    bool check_limits_{false};
+    bool compare_{false};
 
     // Deadline for the current execution (set in onStart)
     std::chrono::steady_clock::time_point deadline_{};
+
+    // EPICS CA PV handle
+    epics::ca::PVHandle pv_;
 };
 
 }  // namespace bchtree
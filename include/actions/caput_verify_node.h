@@ -0,0 +1,340 @@
+#pragma once
+#include <behaviortree_cpp/behavior_tree.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+#include "actions/monitor_port.h"
+#include "epics/ca/ca_pv.h"
+#include "epics/ca/ca_pv_manager.h"
+#include "epics/ca/pv_handle.h"
+#include "epics/types.h"
+
+namespace bchtree {
+
+// Writes a setpoint and waits until a readback PV has converged to it:
+// |readback - value| <= tolerance, held for settle msec. Only readbacks
+// that postdate the put count: monitor updates received after it was
+// issued (and after any readback reconnect), or, when none arrived by the
+// time the put completes, one get of the readback issued then. They are
+// evaluated in the callbacks, so no Sleep nodes are needed while the
+// hardware moves.
+//
+//   readback:  PV to verify, defaults to pv
+//   tolerance: absolute, default 0 (exact)
+//   settle:    msec; checked on ticks, so it resolves within one
+//              sleep-time/max-idle after expiring
+//   timeout:   msec for put and convergence, 0 waits forever
+//   monitor:   monitor policy of the readback channel
+template <typename T>
+class CAPutVerifyNode : public BT::StatefulActionNode {
+    static_assert(std::is_arithmetic_v<T>,
+                  "CAPutVerifyNode compares numeric values");
+
+   public:
+    static constexpr int kDefaultTimeoutMs = 10000;
+
+    explicit CAPutVerifyNode(const std::string& name,
+                             const BT::NodeConfig& cfg,
+                             std::shared_ptr<epics::ca::CAContextManager> ctx,
+                             std::shared_ptr<epics::ca::PVManager> pv_manager)
+        : BT::StatefulActionNode(name, cfg),
+          ctx_(ctx),
+          pv_manager_(pv_manager),
+          rbv_(pv_manager_,
+               [this](bool connected) { handleReadbackConnection(connected); },
+               [this]() { handleReadbackMonitor(); }),
+          pv_(pv_manager_,
+              [this](bool connected) { handleConnection(connected); },
+              nullptr) {
+        ctx_->EnsureAttached();
+        ApplyMonitorPort(cfg, rbv_);
+
+        // Literal pv ports are resolved once here; remapped ones in onStart
+        static_pv_ = ResolveLiteralPort(cfg, "pv", pv_);
+        static_rbv_ = ResolveLiteralPort(cfg, "readback", rbv_);
+        auto it = cfg.input_ports.find("readback");
+        if (it == cfg.input_ports.end() || it->second.empty()) {
+            follow_pv_ = true;
+            if (static_pv_) rbv_.Resolve(pv_.Name());
+        }
+    }
+
+    // Ports definition for BehaviorTree.CPP
+    static BT::PortsList providedPorts() {
+        using namespace BT;
+        return {
+            InputPort<std::string>("pv"),
+            InputPort<std::string>("readback"),
+            InputPort<std::string>("monitor"),
+            InputPort<T>("value"),
+            InputPort<double>("tolerance"),
+            InputPort<int>("settle"),
+            InputPort<int>("timeout"),
+            OutputPort<T>("result"),
+        };
+    }
+
+    // Lifecycle
+    BT::NodeStatus onStart() override {
+        if (!static_pv_) {
+            // Re-resolves only if the blackboard value changed
+            auto pv_name = BT::TreeNode::getInput<std::string>("pv");
+            if (!pv_name) {
+                throw BT::RuntimeError(
+                    "CAPutVerifyNode: missing required input [pv]");
+            }
+            pv_.Resolve(pv_name.value());
+        }
+        if (follow_pv_) {
+            rbv_.Resolve(pv_.Name());
+        } else if (!static_rbv_) {
+            auto rbv_name = BT::TreeNode::getInput<std::string>("readback");
+            if (!rbv_name) {
+                throw BT::RuntimeError(
+                    "CAPutVerifyNode: missing required input [readback]");
+            }
+            rbv_.Resolve(rbv_name.value());
+        }
+        if (!rbv_->RequestMonitor()) {
+            throw BT::RuntimeError("CAPutVerifyNode: monitor policy of [",
+                                   rbv_.Name(), "] is off");
+        }
+
+        auto target = BT::TreeNode::getInput<T>("value");
+        if (!target) {
+            throw BT::RuntimeError(
+                "CAPutVerifyNode: missing required input [value]");
+        }
+        int settle_ms = 0;
+        BT::TreeNode::getInput("settle", settle_ms);
+        int timeout_ms = kDefaultTimeoutMs;
+        BT::TreeNode::getInput("timeout", timeout_ms);
+
+        {
+            // Callbacks read these; they are disarmed at this point
+            std::lock_guard<std::mutex> lock(cond_mtx_);
+            target_ = target.value();
+            tolerance_ = 0.0;
+            BT::TreeNode::getInput("tolerance", tolerance_);
+            settle_ = std::chrono::milliseconds(settle_ms);
+            put_done_ = false;
+            put_failed_ = false;
+            satisfied_ = false;
+            timeout_ms_ = timeout_ms;
+            error_.clear();
+            // A put still outstanding from a halted execution must not
+            // complete this one before issuePut() runs
+            ++put_seq_;
+            armed_ = true;
+        }
+        requested_ = false;
+
+        has_deadline_ = timeout_ms > 0;
+        deadline_ = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(timeout_ms);
+
+        if (!rbv_->IsConnected()) rbv_->Connect();
+        if (!pv_->IsConnected()) {
+            pv_->Connect();
+            return BT::NodeStatus::RUNNING;
+        }
+        issuePut();
+        return BT::NodeStatus::RUNNING;
+    }
+
+    BT::NodeStatus onRunning() override {
+        if (!requested_ && pv_->IsConnected()) {
+            issuePut();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(cond_mtx_);
+            if (!error_.empty()) {
+                armed_ = false;
+                throw BT::RuntimeError("CAPutVerifyNode: ", error_);
+            }
+            if (put_failed_) {
+                armed_ = false;
+                return BT::NodeStatus::FAILURE;
+            }
+            if (satisfied_ &&
+                std::chrono::steady_clock::now() - satisfied_since_ >=
+                    settle_) {
+                armed_ = false;
+                setOutput("result", last_value_);
+                return BT::NodeStatus::SUCCESS;
+            }
+        }
+
+        if (has_deadline_ && std::chrono::steady_clock::now() > deadline_) {
+            disarm();
+            return BT::NodeStatus::FAILURE;
+        }
+        return BT::NodeStatus::RUNNING;
+    }
+
+    void onHalted() override { disarm(); }
+
+    CAPutVerifyNode(const CAPutVerifyNode&) = delete;
+    CAPutVerifyNode& operator=(const CAPutVerifyNode&) = delete;
+
+   private:
+    void issuePut() {
+        // Identifies this execution's put so a late completion from a
+        // halted one is ignored
+        const uint64_t seq = ++put_seq_;
+        {
+            // Readbacks up to here may describe the old setpoint
+            std::lock_guard<std::mutex> lock(cond_mtx_);
+            updates_at_put_ = rbv_->ValueUpdates();
+        }
+        bool status = pv_.PutCB(target_, [this, seq](bool success) {
+            handlePutResult(seq, success);
+        });
+        if (!status) {
+            throw BT::RuntimeError("CAPutVerifyNode: failed to call PutCB");
+        }
+        requested_ = true;
+    }
+
+    // True when the latest monitor update postdates the put.
+    // Caller holds cond_mtx_.
+    bool freshReadback() const {
+        return rbv_->ValueUpdates() > updates_at_put_ && rbv_->HasValue();
+    }
+
+    // Re-evaluate the latest monitor update; true when it just converged.
+    // Caller holds cond_mtx_.
+    bool updateSatisfied() {
+        if (!armed_ || !put_done_ || !freshReadback()) return false;
+
+        T value;
+        try {
+            value = rbv_->GetAs<T>();
+        } catch (const std::exception& e) {
+            // Runs on a callback thread; reported from onRunning()
+            error_ = e.what();
+            return true;
+        }
+        return evaluate(value);
+    }
+
+    // Caller holds cond_mtx_
+    bool evaluate(T value) {
+        if (std::abs(static_cast<double>(value) -
+                     static_cast<double>(target_)) > tolerance_) {
+            satisfied_ = false;
+            return false;
+        }
+        last_value_ = value;
+        if (satisfied_) return false;
+
+        satisfied_ = true;
+        satisfied_since_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void disarm() {
+        std::lock_guard<std::mutex> lock(cond_mtx_);
+        armed_ = false;
+    }
+
+    void handlePutResult(uint64_t seq, bool success) {
+        bool read_back = false;
+        {
+            std::lock_guard<std::mutex> lock(cond_mtx_);
+            if (!armed_ || seq != put_seq_) return;
+
+            if (success) {
+                put_done_ = true;
+                // An unchanged readback posts no update, so read it once
+                read_back = !updateSatisfied() && !freshReadback();
+            } else {
+                put_failed_ = true;
+            }
+        }
+        if (read_back) requestReadback(seq);
+        emitWakeUpSignal();
+    }
+
+    // The reply is served after the put was processed. Issued without
+    // cond_mtx_ held; a failure is not fatal, as the next monitor update
+    // is evaluated anyway.
+    void requestReadback(uint64_t seq) {
+        rbv_.GetCBAs<T>(
+            [this, seq](T value) { handleReadbackGet(seq, value); },
+            std::chrono::milliseconds(timeout_ms_));
+    }
+
+    void handleReadbackGet(uint64_t seq, T value) {
+        std::lock_guard<std::mutex> lock(cond_mtx_);
+        if (!armed_ || seq != put_seq_) return;
+        // A monitor update that arrived meanwhile is newer than the reply
+        if (freshReadback()) return;
+        if (evaluate(value)) {
+            emitWakeUpSignal();
+        }
+    }
+
+    void handleConnection(bool connected) {
+        if (connected && status() == BT::NodeStatus::RUNNING) {
+            emitWakeUpSignal();
+        }
+    }
+
+    void handleReadbackConnection(bool connected) {
+        if (connected) return;
+
+        // Value is stale until the first monitor update after reconnect
+        std::lock_guard<std::mutex> lock(cond_mtx_);
+        satisfied_ = false;
+        updates_at_put_ = rbv_->ValueUpdates();
+    }
+
+    void handleReadbackMonitor() {
+        // Property changes run this too; freshReadback() ignores them
+        std::lock_guard<std::mutex> lock(cond_mtx_);
+        if (updateSatisfied()) {
+            emitWakeUpSignal();
+        }
+    }
+
+    std::shared_ptr<epics::ca::CAContextManager> ctx_;
+    std::shared_ptr<epics::ca::PVManager> pv_manager_;
+
+    // Verification state shared with the put and monitor callbacks
+    std::mutex cond_mtx_;
+    bool armed_{false};
+    T target_{};
+    double tolerance_{0.0};
+    std::chrono::milliseconds settle_{0};
+    bool put_done_{false};
+    bool put_failed_{false};
+    bool satisfied_{false};
+    std::chrono::steady_clock::time_point satisfied_since_{};
+    T last_value_{};
+    std::string error_;
+    std::atomic<uint64_t> put_seq_{0};
+    int timeout_ms_{kDefaultTimeoutMs};
+    // Readback ValueUpdates() when the put was issued or the readback last
+    // disconnected
+    uint64_t updates_at_put_{0};
+
+    bool static_pv_{false};
+    bool static_rbv_{false};
+    bool follow_pv_{false};
+    std::atomic<bool> requested_{false};
+    bool has_deadline_{false};
+    std::chrono::steady_clock::time_point deadline_{};
+
+    // EPICS CA PV handles
+    epics::ca::PVHandle rbv_;
+    epics::ca::PVHandle pv_;
+};
+
+}  // namespace bchtree
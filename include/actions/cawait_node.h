@@ -0,0 +1,256 @@
+#pragma once
+#include <behaviortree_cpp/behavior_tree.h>
+
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+#include "actions/monitor_port.h"
+#include "epics/ca/ca_pv.h"
+#include "epics/ca/ca_pv_manager.h"
+#include "epics/ca/pv_handle.h"
+#include "epics/types.h"
+
+namespace bchtree {
+
+// Waits until a PV satisfies a condition, optionally for a minimum time.
+// The condition is evaluated in the monitor callback and the tree is only
+// woken when it becomes true, so no gets are issued while waiting.
+//
+//   op: eq | ne | lt | le | gt | ge   compare with value
+//       within                       |pv - value| <= tolerance
+//       mask                         (pv & mask) == (value & mask)
+//   timeout: msec, 0 (default) waits forever
+//   stable:  msec the condition must hold before SUCCESS; checked on ticks,
+//            so it resolves within one sleep-time/max-idle after expiring
+template <typename T>
+class CAWaitNode : public BT::StatefulActionNode {
+   public:
+    explicit CAWaitNode(const std::string& name, const BT::NodeConfig& cfg,
+                        std::shared_ptr<epics::ca::CAContextManager> ctx,
+                        std::shared_ptr<epics::ca::PVManager> pv_manager)
+        : BT::StatefulActionNode(name, cfg),
+          ctx_(ctx),
+          pv_manager_(pv_manager),
+          pv_(pv_manager_,
+              [this](bool connected) { handleConnection(connected); },
+              [this]() { handleMonitor(); }) {
+        ctx_->EnsureAttached();
+        ApplyMonitorPort(cfg, pv_);
+
+        // Literal pv ports are resolved once here; remapped ones in onStart
+        static_pv_ = ResolveLiteralPort(cfg, "pv", pv_);
+    }
+
+    // Ports definition for BehaviorTree.CPP
+    static BT::PortsList providedPorts() {
+        using namespace BT;
+        return {
+            InputPort<std::string>("pv"),
+            InputPort<std::string>("monitor"),
+            InputPort<T>("value"),
+            InputPort<std::string>("op"),
+            InputPort<double>("tolerance"),
+            InputPort<int>("mask"),
+            InputPort<int>("timeout"),
+            InputPort<int>("stable"),
+            OutputPort<T>("result"),
+        };
+    }
+
+    BT::NodeStatus onStart() override {
+        if (!static_pv_) {
+            auto pv_name = BT::TreeNode::getInput<std::string>("pv");
+            if (!pv_name) {
+                throw BT::RuntimeError(
+                    "CAWaitNode: missing required input [pv]");
+            }
+            pv_.Resolve(pv_name.value());
+        }
+        if (!pv_->RequestMonitor()) {
+            throw BT::RuntimeError("CAWaitNode: monitor policy of [",
+                                   pv_.Name(), "] is off");
+        }
+
+        auto target = BT::TreeNode::getInput<T>("value");
+        if (!target) {
+            throw BT::RuntimeError(
+                "CAWaitNode: missing required input [value]");
+        }
+        std::string op = "eq";
+        BT::TreeNode::getInput("op", op);
+        int timeout_ms = 0;
+        BT::TreeNode::getInput("timeout", timeout_ms);
+        int stable_ms = 0;
+        BT::TreeNode::getInput("stable", stable_ms);
+
+        {
+            // Monitor callbacks read these; they are disarmed at this point
+            std::lock_guard<std::mutex> lock(cond_mtx_);
+            target_ = target.value();
+            op_ = parseOp(op);
+            BT::TreeNode::getInput("tolerance", tolerance_);
+            BT::TreeNode::getInput("mask", mask_);
+            stable_ = std::chrono::milliseconds(stable_ms);
+            satisfied_ = false;
+            error_.clear();
+            armed_ = true;
+            updateSatisfied();
+        }
+
+        has_deadline_ = timeout_ms > 0;
+        deadline_ = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(timeout_ms);
+
+        if (!pv_->IsConnected()) {
+            pv_->Connect();
+        }
+        return onRunning();
+    }
+
+    BT::NodeStatus onRunning() override {
+        {
+            std::lock_guard<std::mutex> lock(cond_mtx_);
+            if (!error_.empty()) {
+                armed_ = false;
+                throw BT::RuntimeError("CAWaitNode: ", error_);
+            }
+            if (satisfied_ &&
+                std::chrono::steady_clock::now() - satisfied_since_ >=
+                    stable_) {
+                armed_ = false;
+                setOutput("result", last_value_);
+                return BT::NodeStatus::SUCCESS;
+            }
+        }
+
+        if (has_deadline_ && std::chrono::steady_clock::now() > deadline_) {
+            disarm();
+            return BT::NodeStatus::FAILURE;
+        }
+        return BT::NodeStatus::RUNNING;
+    }
+
+    void onHalted() override { disarm(); }
+
+    CAWaitNode(const CAWaitNode&) = delete;
+    CAWaitNode& operator=(const CAWaitNode&) = delete;
+
+   private:
+    enum class Op { kEq, kNe, kLt, kLe, kGt, kGe, kWithin, kMask };
+
+    static Op parseOp(const std::string& op) {
+        if (op == "eq") return Op::kEq;
+        if (op == "ne") return Op::kNe;
+        if (op == "lt") return Op::kLt;
+        if (op == "le") return Op::kLe;
+        if (op == "gt") return Op::kGt;
+        if (op == "ge") return Op::kGe;
+        if (op == "within" && std::is_arithmetic_v<T>) return Op::kWithin;
+        if (op == "mask" && std::is_integral_v<T>) return Op::kMask;
+        throw BT::RuntimeError("CAWaitNode: unsupported op [", op, "]");
+    }
+
+    bool matches(const T& v) const {
+        switch (op_) {
+            case Op::kEq:
+                return v == target_;
+            case Op::kNe:
+                return v != target_;
+            case Op::kLt:
+                return v < target_;
+            case Op::kLe:
+                return v <= target_;
+            case Op::kGt:
+                return v > target_;
+            case Op::kGe:
+                return v >= target_;
+            case Op::kWithin:
+                if constexpr (std::is_arithmetic_v<T>) {
+                    return std::abs(static_cast<double>(v) -
+                                    static_cast<double>(target_)) <=
+                           tolerance_;
+                }
+                return false;
+            case Op::kMask:
+                if constexpr (std::is_integral_v<T>) {
+                    return (v & mask_) == (target_ & mask_);
+                }
+                return false;
+        }
+        return false;
+    }
+
+    // Re-evaluate the latest value; true when the condition just became
+    // satisfied. Caller holds cond_mtx_.
+    bool updateSatisfied() {
+        if (!armed_ || !pv_->HasValue()) return false;
+
+        T value;
+        try {
+            value = pv_->GetAs<T>();
+        } catch (const std::exception& e) {
+            // Runs on the CA thread; reported from onRunning()
+            error_ = e.what();
+            return true;
+        }
+
+        if (!matches(value)) {
+            satisfied_ = false;
+            return false;
+        }
+        last_value_ = value;
+        if (satisfied_) return false;
+
+        satisfied_ = true;
+        satisfied_since_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void disarm() {
+        std::lock_guard<std::mutex> lock(cond_mtx_);
+        armed_ = false;
+    }
+
+    void handleConnection(bool connected) {
+        if (connected) return;
+
+        // Value is stale until the first monitor update after reconnect
+        std::lock_guard<std::mutex> lock(cond_mtx_);
+        satisfied_ = false;
+    }
+
+    void handleMonitor() {
+        std::lock_guard<std::mutex> lock(cond_mtx_);
+        if (updateSatisfied()) {
+            emitWakeUpSignal();
+        }
+    }
+
+    std::shared_ptr<epics::ca::CAContextManager> ctx_;
+    std::shared_ptr<epics::ca::PVManager> pv_manager_;
+
+    // Condition state shared with the monitor callback
+    std::mutex cond_mtx_;
+    bool armed_{false};
+    T target_{};
+    Op op_{Op::kEq};
+    double tolerance_{0.0};
+    int mask_{~0};
+    std::chrono::milliseconds stable_{0};
+    bool satisfied_{false};
+    std::chrono::steady_clock::time_point satisfied_since_{};
+    T last_value_{};
+    std::string error_;
+
+    bool static_pv_{false};
+    bool has_deadline_{false};
+    std::chrono::steady_clock::time_point deadline_{};
+
+    // EPICS CA PV handle
+    epics::ca::PVHandle pv_;
+};
+
+}  // namespace bchtree
@@ -0,0 +1,52 @@
+#pragma once
+#include <behaviortree_cpp/behavior_tree.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "epics/ca/ca_pv.h"
+#include "epics/ca/pv_handle.h"
+
+namespace bchtree {
+
+// Value of a port given as a literal in the XML; false if the port is
+// missing, empty or remapped to the blackboard.
+inline bool LiteralPort(const BT::NodeConfig& cfg, const char* port,
+                        std::string& out) {
+    auto it = cfg.input_ports.find(port);
+    if (it == cfg.input_ports.end() || it->second.empty() ||
+        BT::TreeNode::isBlackboardPointer(it->second)) {
+        return false;
+    }
+    out = it->second;
+    return true;
+}
+
+// Resolves pv from a literal PV name port at construction; false when the
+// name has to be read from the blackboard on each start.
+inline bool ResolveLiteralPort(const BT::NodeConfig& cfg, const char* port,
+                               epics::ca::PVHandle& pv) {
+    std::string name;
+    if (!LiteralPort(cfg, port, name)) return false;
+    pv.Resolve(name);
+    return true;
+}
+
+// Optional "monitor" port of nodes that read or compare monitor data, e.g.
+// monitor="log,200ms" (see MonitorPolicy::Parse). The policy is applied to
+// the channel when it is resolved, so only literal values are accepted.
+inline void ApplyMonitorPort(const BT::NodeConfig& cfg,
+                             epics::ca::PVHandle& pv) {
+    auto it = cfg.input_ports.find("monitor");
+    if (it == cfg.input_ports.end() || it->second.empty()) return;
+    if (BT::TreeNode::isBlackboardPointer(it->second)) {
+        throw BT::RuntimeError("[monitor] must be a literal policy");
+    }
+    try {
+        pv.SetMonitorPolicy(epics::ca::MonitorPolicy::Parse(it->second));
+    } catch (const std::invalid_argument& e) {
+        throw BT::RuntimeError(e.what());
+    }
+}
+
+}  // namespace bchtree
@@ -4,10 +4,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "epics/ca/ca_context_manager.h"
 #include "epics/ca/ca_pv_manager.h"
 #include "logger.h"
+#include "metrics.h"
+#include "trace_recorder.h"
+#include "tree_cache.h"
 
 namespace bchtree {
 
@@ -31,21 +35,97 @@ class RunnerLogger : public BT::StatusChangeLogger {
     std::shared_ptr<Logger> logger_;
 };
 
+// Records how long each node stays RUNNING (RUNNING -> SUCCESS/FAILURE)
+// into the "node_latency" family, labelled by the node's full path.
+class NodeMetricsLogger : public BT::StatusChangeLogger {
+   public:
+    // label_prefix is prepended to node paths, e.g. "<tree name>/"
+    NodeMetricsLogger(const BT::Tree& tree, Metrics& metrics,
+                      const std::string& label_prefix = "");
+    ~NodeMetricsLogger() override;
+
+    NodeMetricsLogger(const NodeMetricsLogger&) = delete;
+    NodeMetricsLogger& operator=(const NodeMetricsLogger&) = delete;
+    NodeMetricsLogger(NodeMetricsLogger&&) = delete;
+    NodeMetricsLogger& operator=(NodeMetricsLogger&&) = delete;
+
+    virtual void flush() override {}
+
+   private:
+    virtual void callback(BT::Duration timestamp, const BT::TreeNode& node,
+                          BT::NodeStatus prev_status,
+                          BT::NodeStatus status) override;
+
+    // Indexed by node UID
+    std::vector<LatencyHistogram*> histograms_;
+    std::vector<std::chrono::steady_clock::time_point> started_;
+};
+
+// Poll: re-tick every sleep_time while the tree is RUNNING.
+// Event: block until a node emits a wake-up signal (CA get/put/connection/
+// monitor callback), re-ticking at most every max_idle as a fallback for
+// node timeouts.
+enum class TickMode { kPoll, kEvent };
+
 class BTRunner {
    public:
     explicit BTRunner(std::shared_ptr<epics::ca::CAContextManager> ctx,
                       std::shared_ptr<epics::ca::PVManager> pv_manager)
         : ctx_(std::move(ctx)), pv_manager_(std::move(pv_manager)) {}
+    ~BTRunner();
+
+    BTRunner(const BTRunner&) = delete;
+    BTRunner& operator=(const BTRunner&) = delete;
 
     bool Run(
         std::chrono::milliseconds sleep_time = std::chrono::milliseconds(10));
     void PrintTree();
+    void SetTickMode(
+        TickMode mode,
+        std::chrono::milliseconds max_idle = std::chrono::milliseconds(100));
     void SetLogger(std::shared_ptr<Logger> logger);
+    // Distinguishes this tree in logs and metric labels when several
+    // runners share a process
+    void SetTreeName(std::string name);
+    const std::string& TreeName() const { return tree_name_; }
     void SetGlobalBB(std::string key, std::string value);
     void UseRunnerLogger();
+    // Record every node status change into a binary ring file
+    void UseTraceRecorder(const std::string& path, size_t capacity);
     void RegisterTreeFromFile(const std::string& treePath);
+    // Instantiate trees from cache instead of parsing the XML each time.
+    // The cache must register nodes for the same ctx and PVManager.
+    void SetTreeCache(std::shared_ptr<TreeCache> cache);
+    // Watch the tree file and its includes (inotify); on change, rebuild the
+    // tree between ticks and restart it from the root. Channels stay
+    // connected because the new nodes pick up the live CAPVs. Call before
+    // RegisterTreeFromFile().
+    void EnableHotReload();
+    // Registers every bch-tree node type against ctx and pv_manager
+    static void RegisterNodes(
+        BT::BehaviorTreeFactory& factory,
+        const std::shared_ptr<epics::ca::CAContextManager>& ctx,
+        const std::shared_ptr<epics::ca::PVManager>& pv_manager);
+    // After loading, wait until min_ratio (0.0-1.0) of the statically named
+    // PVs are connected or timeout expires. 0.0 disables waiting.
+    void SetPrewarmWait(double min_ratio, std::chrono::milliseconds timeout);
+    // Record node and tick latencies; written to path (json|prometheus)
+    // when Run() returns and whenever Metrics::RequestDump() was called.
+    void SetMetrics(std::shared_ptr<Metrics> metrics, std::string path,
+                    std::string format);
 
    private:
+    BT::NodeStatus TickOnceBatched();
+    BT::NodeStatus TickWhileRunning(std::chrono::milliseconds sleep_time);
+    // wait: honour SetPrewarmWait(); false when swapping in a reloaded tree
+    void PrewarmPVs(bool wait);
+    void AttachLoggers();
+    void DetachLoggers();
+    void WatchTreeFiles();
+    void PollHotReload();
+    void DumpMetrics();
+    std::string LogSuffix() const;
+
     std::shared_ptr<Logger> logger_;
     BT::BehaviorTreeFactory factory_;
     BT::Tree tree_;
@@ -53,12 +133,39 @@ class BTRunner {
 
     std::shared_ptr<epics::ca::CAContextManager> ctx_;
     std::shared_ptr<epics::ca::PVManager> pv_manager_;
+    std::shared_ptr<TreeCache> tree_cache_;
 
+    std::string tree_name_;
     bool initialized_{false};
     bool use_runner_logger_{false};
+    TickMode tick_mode_{TickMode::kPoll};
+    std::chrono::milliseconds max_idle_{100};
+
+    double prewarm_min_ratio_{0.0};
+    std::chrono::milliseconds prewarm_timeout_{0};
+    std::vector<std::shared_ptr<epics::ca::CAPV>> prewarmed_pvs_;
     std::unique_ptr<RunnerLogger> runner_logger_;
+    std::shared_ptr<TraceRecorder> trace_recorder_;
+    std::unique_ptr<TraceLogger> trace_logger_;
+
+    std::shared_ptr<Metrics> metrics_;
+    std::string metrics_path_;
+    std::string metrics_format_;
+    LatencyHistogram* tick_histogram_{nullptr};
+    std::unique_ptr<NodeMetricsLogger> node_metrics_logger_;
 
     std::unordered_map<std::string, std::string> globals_bb_map_;
+
+    bool hot_reload_{false};
+    int inotify_fd_{-1};
+    std::string tree_path_;
+    TreeCache::Fingerprint tree_fingerprint_;
+    // Previous tree after a reload; kept for a grace period so channels
+    // resolved from the blackboard at runtime are not dropped before the
+    // new tree resolves them again.
+    BT::Tree retired_tree_;
+    std::chrono::steady_clock::time_point retired_at_;
+    bool has_retired_tree_{false};
 };
 
 }  // namespace bchtree
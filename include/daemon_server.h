@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bt_runner.h"
+#include "epics/ca/ca_context_manager.h"
+#include "epics/ca/ca_pv_manager.h"
+#include "logger.h"
+#include "tree_cache.h"
+
+namespace bchtree {
+
+// Wire format (one line each way, fields separated by '\t'):
+//   request: run <tree path> [key=value ...]
+//   reply:   <SUCCESS|FAILURE> <load ms> <run ms>  |  ERROR <message>
+struct DaemonRequest {
+    std::string tree_path;
+    std::vector<std::pair<std::string, std::string>> globals;
+};
+
+struct DaemonReply {
+    std::string status;  // SUCCESS, FAILURE or ERROR
+    double load_ms{0.0};
+    double run_ms{0.0};
+    std::string error;
+};
+
+// Throws std::invalid_argument if a field contains a tab or newline
+std::string EncodeDaemonRequest(const DaemonRequest& request);
+bool DecodeDaemonRequest(const std::string& line, DaemonRequest& request);
+std::string EncodeDaemonReply(const DaemonReply& reply);
+bool DecodeDaemonReply(const std::string& line, DaemonReply& reply);
+
+// Long-lived process that keeps the CA context and PVManager warm and runs
+// trees submitted over a Unix domain socket. Each request gets a fresh
+// BTRunner (own blackboard) but reuses tree files already parsed, and
+// channels connected by earlier runs as long as the PVManager lets them
+// linger after release. Requests are served concurrently.
+class DaemonServer {
+   public:
+    // Linger limit the CLI applies in daemon mode unless
+    // --linger-channels is given
+    static constexpr size_t kDefaultLingerChannels = 1024;
+
+    DaemonServer(std::shared_ptr<epics::ca::CAContextManager> ctx,
+                 std::shared_ptr<epics::ca::PVManager> pv_manager);
+    ~DaemonServer();
+
+    DaemonServer(const DaemonServer&) = delete;
+    DaemonServer& operator=(const DaemonServer&) = delete;
+
+    void SetLogger(std::shared_ptr<Logger> logger);
+    // Applied to every runner before the tree is loaded (tick mode,
+    // prewarm, metrics...)
+    void SetRunnerConfig(std::function<void(BTRunner&)> configure);
+
+    // Bind the socket, replacing a stale one; throws std::runtime_error
+    void Listen(const std::string& socket_path);
+    // Accept requests until Stop(); waits for running requests to finish
+    void Serve(std::chrono::milliseconds sleep_time);
+    // Async-signal-safe
+    void Stop() { stop_requested_.store(true); }
+
+   private:
+    void HandleConnection(int fd, std::chrono::milliseconds sleep_time);
+    DaemonReply RunRequest(const DaemonRequest& request,
+                           std::chrono::milliseconds sleep_time);
+
+    std::shared_ptr<epics::ca::CAContextManager> ctx_;
+    std::shared_ptr<epics::ca::PVManager> pv_manager_;
+    std::shared_ptr<Logger> logger_;
+    std::function<void(BTRunner&)> configure_;
+    std::shared_ptr<TreeCache> tree_cache_;
+
+    int listen_fd_{-1};
+    std::string socket_path_;
+    std::atomic<bool> stop_requested_{false};
+
+    std::mutex active_mtx_;
+    std::condition_variable active_cv_;
+    size_t active_{0};
+};
+
+// Send one request to a daemon and wait for its reply; throws
+// std::runtime_error on socket errors
+DaemonReply SubmitToDaemon(const std::string& socket_path,
+                           const DaemonRequest& request);
+
+}  // namespace bchtree
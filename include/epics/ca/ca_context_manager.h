@@ -1,9 +1,15 @@
 #pragma once
 #include <cadef.h>
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 
+#include "epics/ca/callback_dispatcher.h"
+#include "epics/ca/monitor_coalescer.h"
+#include "logger.h"
+#include "metrics.h"
+
 namespace bchtree::epics::ca {
 class CAContextManager {
    public:
@@ -13,10 +19,63 @@ class CAContextManager {
     void EnsureAttached();
     void Shutdown();
 
+    // I/O batching: while a batch is open on the calling thread,
+    // RequestFlush() only counts pending requests and ca_flush_io() runs
+    // once when the outermost batch ends or flush_threshold requests have
+    // accumulated.
+    void BeginBatch();
+    void EndBatch();
+    void RequestFlush();
+    void SetFlushThreshold(size_t threshold);
+    // ca_flush_io() calls issued through RequestFlush()/EndBatch()
+    uint64_t FlushCount() const { return flushes_; }
+
+    // Optional sink for CA round-trip and connection times; set before
+    // channels are created.
+    void SetMetrics(std::shared_ptr<Metrics> metrics);
+    Metrics* GetMetrics() const { return metrics_.get(); }
+    // Optional sink for channel and node diagnostics; set before channels
+    // are created. Null when unset.
+    void SetLogger(std::shared_ptr<Logger> logger);
+    Logger* GetLogger() const { return logger_.get(); }
+
+    // Thread on which CAPV delivers events to user callbacks; inline on
+    // the CA threads unless a DispatchPolicy is set
+    CallbackDispatcher& Dispatcher() { return dispatcher_; }
+
+    // Trailing notifications for channels with a monitor min_interval
+    MonitorCoalescer& Coalescer() { return coalescer_; }
+
    private:
+    void Flush();
+
     std::mutex mtx_;
     ca_client_context* ctx_;
     bool initialized_ = false;
+
+    std::atomic<size_t> flush_threshold_{256};
+    std::atomic<uint64_t> flushes_{0};
+
+    std::shared_ptr<Metrics> metrics_;
+    std::shared_ptr<Logger> logger_;
+
+    // The coalescer posts to the dispatcher, so it must stop first
+    CallbackDispatcher dispatcher_{*this};
+    // Last so its worker stops before the rest of the manager goes away
+    MonitorCoalescer coalescer_{*this};
+};
+
+// RAII helper to defer CA flushes for the duration of a scope (e.g. a tick)
+class IOBatch {
+   public:
+    explicit IOBatch(CAContextManager& ctx) : ctx_(ctx) { ctx_.BeginBatch(); }
+    ~IOBatch() { ctx_.EndBatch(); }
+
+    IOBatch(const IOBatch&) = delete;
+    IOBatch& operator=(const IOBatch&) = delete;
+
+   private:
+    CAContextManager& ctx_;
 };
 
 }  // namespace bchtree::epics::ca
@@ -1,10 +1,17 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 
 #include "epics/ca/ca_context_manager.h"
+#include "epics/ca/request_pool.h"
 #include "epics/types.h"
 
 namespace bchtree::epics::ca {
@@ -12,151 +19,378 @@ namespace bchtree::epics::ca {
 using GetCallback = std::function<void(PVData)>;
 using PutCallback = std::function<void(bool)>;
 using ConnCallback = std::function<void(bool)>;
+using MonitorCallback = std::function<void()>;
+using CallbackId = uint64_t;
 class CAPV;
 
 template <typename T>
 using GetCallbackAs = std::function<void(T)>;
+// Why a get was not answered: the CA status or the decode error
+using GetErrorCallback = std::function<void(const std::string&)>;
 
+// How a channel subscribes for value updates. Channels are shared, so
+// policies set by several users are merged into one that satisfies all;
+// the manager's default only applies while no user has set one.
+struct MonitorPolicy {
+    enum class Mode {
+        kOff,   // never subscribe; readers fall back to gets
+        kLazy,  // subscribe on the first RequestMonitor()
+        kOn,    // subscribe as soon as the channel connects
+    };
+    Mode mode = Mode::kOn;
+    // DBE_VALUE follows MDEL, DBE_LOG the archive deadband (ADEL)
+    unsigned long mask = DBE_VALUE | DBE_ALARM;
+    // Monitor callbacks run at most once per interval; the value is always
+    // stored and the last update in an interval is delivered at its end
+    std::chrono::milliseconds min_interval{0};
+
+    // Comma-separated words: "off" or "lazy", "value" and/or "log", and
+    // "<N>ms" for min_interval, e.g. "lazy,log,100ms". Throws
+    // std::invalid_argument on an unknown word.
+    static MonitorPolicy Parse(const std::string& spec);
+    // Never narrows either side; "off" yields to any other policy
+    MonitorPolicy Merge(const MonitorPolicy& other) const;
+    // In Parse() syntax
+    std::string ToString() const;
+    bool operator==(const MonitorPolicy& other) const;
+};
+
+// Link between a requester and the completions of its gets and puts. A
+// channel may outlive the requester (it is shared, or lingers), so a
+// reply can arrive after the requester is gone. Once Revoke() returns,
+// no completion issued with the token is running or will run.
+class RequestToken {
+   public:
+    void Revoke() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        revoked_ = true;
+    }
+
+    // Runs fn unless revoked; Revoke() waits until it returns
+    template <typename F>
+    static void Invoke(RequestToken* token, F&& fn) {
+        if (!token) {
+            fn();
+            return;
+        }
+        std::lock_guard<std::mutex> lock(token->mtx_);
+        if (!token->revoked_) fn();
+    }
+
+   private:
+    std::mutex mtx_;
+    bool revoked_{false};
+};
+
+// Pooled per-request state. Callbacks that capture no more than a pointer
+// or two fit std::function's inline buffer, so issuing a request does not
+// touch the heap once the pool is warm.
 template <typename T>
 struct GetCBCtxAs {
-    CAPV* self;
+    CAPV* self = nullptr;
     GetCallbackAs<T> cb;
+    GetErrorCallback on_error;            // null: failures are reported
+    std::shared_ptr<RequestToken> token;  // null if never revoked
+    T value{};  // decoded reply, held while the callback is dispatched
+    std::string error;  // set instead of value when the get failed
+    // Round-trip sink; null when metrics are disabled
+    LatencyHistogram* rtt = nullptr;
+    std::chrono::steady_clock::time_point issued;
 };
 
 class CAPV {
    public:
-    explicit CAPV(std::shared_ptr<CAContextManager> ctx, std::string pv_name);
+    explicit CAPV(std::shared_ptr<CAContextManager> ctx, std::string pv_name,
+                  MonitorPolicy policy = {});
     ~CAPV() noexcept;
 
-    void AddConnCB(ConnCallback cb);
+    // Callbacks run on the CA thread, or where the context's
+    // CallbackDispatcher delivers them. Once Remove*CB() returns, the
+    // callback is guaranteed not to be running or called again.
+    CallbackId AddConnCB(ConnCallback cb);
+    void RemoveConnCB(CallbackId id);
+    // Called after each monitor update has been stored, and when the
+    // channel properties change; ValueUpdates() tells the two apart.
+    CallbackId AddMonitorCB(MonitorCallback cb);
+    void RemoveMonitorCB(CallbackId id);
     void Connect();
 
+    // Sets a user's monitor policy. The first one replaces the default
+    // the channel was created with; later ones are merged with it, and a
+    // policy that does not survive the merge as given is reported.
+    // Resubscribes when the subscription no longer matches.
+    void ApplyMonitorPolicy(const MonitorPolicy& policy);
+    MonitorPolicy GetMonitorPolicy() const;
+    // Called by readers of monitor data. Starts a lazy subscription (now
+    // or on connection); false if the policy is off.
+    bool RequestMonitor();
+
+    // Latest monitor value as an immutable snapshot shared with other
+    // readers; never null. Holding it keeps the data alive across updates.
+    std::shared_ptr<const PVData> Snapshot() const {
+        auto snap = std::atomic_load(&snapshot_);
+        return snap ? snap : EmptySnapshot();
+    }
+
+    // Channel properties from DBR_CTRL_*, subscribed on connection with
+    // DBE_PROPERTY: the initial update fills the cache and later updates
+    // replace it. Null until the first update arrived; kept across
+    // reconnections. Monitor callbacks run on each update.
+    std::shared_ptr<const PVControlInfo> ControlInfo() const {
+        return std::atomic_load(&control_info_);
+    }
+
+    // Enum values read as std::string give the state string once the
+    // properties are known and the decimal index otherwise.
     template <typename T>
-    T GetAs() {
+    T GetAs() const {
+        const auto snap = Snapshot();
         if constexpr (std::is_same_v<T, PVData>) {
             // Don't need convert
-            return pvdata_;
+            return *snap;
         } else {
             // Convert to sample data
-            return extract_as<T>(pvdata_);
+            return Convert<T>(*snap);
         }
     }
 
+    // A get that fails or cannot be decoded is answered through on_error;
+    // without one it is reported and the requester runs into its timeout.
     template <typename T>
-    bool GetCBAs(GetCallbackAs<T> cb, const std::chrono::milliseconds timeout) {
-        auto cb_ctx = std::make_unique<GetCBCtxAs<T>>();
+    bool GetCBAs(GetCallbackAs<T> cb, const std::chrono::milliseconds timeout,
+                 std::shared_ptr<RequestToken> token = nullptr,
+                 GetErrorCallback on_error = nullptr) {
+        if (!ReserveCompletion()) return false;
+        auto cb_ctx = AcquireRequest<GetCBCtxAs<T>>();
         cb_ctx->self = this;
         cb_ctx->cb = std::move(cb);
+        cb_ctx->on_error = std::move(on_error);
+        cb_ctx->token = std::move(token);
+        cb_ctx->rtt = MetricHistogram(get_rtt_hist_, "ca_get_rtt");
+        if (cb_ctx->rtt) cb_ctx->issued = std::chrono::steady_clock::now();
 
         // Pass cb_ctx pointer to user
         GetCBCtxAs<T>* raw = cb_ctx.release();
 
-        const chtype dbr_type = PreferredGetType(native_type_);
+        chtype dbr_type;
+        unsigned long count;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            dbr_type = PreferredGetType(native_type_);
+            count = RequestCount();
+        }
 
-        int st = ca_array_get_callback(dbr_type, static_cast<unsigned long>(1),
-                                       chid_, &GetHandlerAs<T>, raw);
+        int st = ca_array_get_callback(dbr_type, count, chid_,
+                                       &GetHandlerAs<T>, raw);
         if (st != ECA_NORMAL) {
             // Reclaim ownership
-            std::unique_ptr<GetCBCtxAs<T>> reclaim(raw);
-            std::cout << "status=" << st << " : " << ca_message(st) << "\n";
+            PooledRequest<GetCBCtxAs<T>> reclaim(raw);
+            ReleaseCompletion();
+            Report(std::string("get not issued: ") + ca_message(st));
             return false;
         }
-        ca_flush_io();
+        ctx_->RequestFlush();
 
         return true;
     }
 
-    bool PutCB(const PVScalarValue& v, PutCallback cb);
+    bool PutCB(const PVScalarValue& v, PutCallback cb,
+               std::shared_ptr<RequestToken> token = nullptr);
+    bool PutCB(const PVArrayValue& v, PutCallback cb,
+               std::shared_ptr<RequestToken> token = nullptr);
 
     std::string GetPVname() const;
     bool IsConnected() const;
+    // True once a monitor update arrived since the last (re)connection.
+    bool HasValue() const;
+    // Value updates stored so far; counted after the snapshot is replaced,
+    // so a reader seeing a new count also sees that snapshot or a newer one
+    uint64_t ValueUpdates() const { return value_updates_; }
+
+    // Decode a DBR buffer as delivered to CA callbacks (see DecodeDbr).
+    // Decodes as an array when count > 1, as a scalar otherwise.
+    static PVData DecodePVData(chtype type, long count, const void* dbr);
+    static PVData DecodePVScalar(chtype type, const void* dbr);
+    static PVData DecodePVArray(chtype type, long count, const void* dbr);
 
    private:
+    friend class MonitorCoalescer;
+
     static void ConnHandler(struct connection_handler_args args);
+    // Through the context's logger; stdout for contexts without one
+    void Report(const std::string& msg) const;
+    // Dispatcher room for a get/put completion, taken before the request
+    // is issued and given back if it fails or completes without a reply
+    bool ReserveCompletion();
+    void ReleaseCompletion();
+    // Queues a completion into the room taken by ReserveCompletion()
+    void PostCompletion(CallbackDispatcher::TaskFn fn, void* arg,
+                        uintptr_t data = 0);
+    // Shared by the PutCB() overloads: data is count elements of type
+    bool IssuePut(chtype type, unsigned long count, const void* data,
+                  PutCallback cb, std::shared_ptr<RequestToken> token);
     static void PutHandler(struct event_handler_args args);
     static void MonitorHandler(struct event_handler_args args);
+    static void ControlHandler(struct event_handler_args args);
 
     void EnsureStartMonitor(void);
+    void EnsureControlSubscription();
+    // Runs monitor callbacks held back by min_interval
+    void FlushCoalesced();
+    // Runs the monitor callbacks via the dispatcher; at most one such
+    // event per channel is queued, as callbacks read the latest state
+    void NotifyMonitor();
+    // Caller holds monitor_cb_mtx_
+    void NotifyMonitorCBs();
+    // Caller holds mtx_
+    unsigned long RequestCount() const;
     void ClearMonitor(void);
+    // Per-PV histogram of the given family, looked up once and cached in
+    // slot; null when the context has no metrics sink.
+    LatencyHistogram* MetricHistogram(std::atomic<LatencyHistogram*>& slot,
+                                      const char* family);
 
     template <typename T>
     static void GetHandlerAs(struct event_handler_args args) {
-        std::unique_ptr<GetCBCtxAs<T>> cb_ctx(
+        PooledRequest<GetCBCtxAs<T>> cb_ctx(
             static_cast<GetCBCtxAs<T>*>(args.usr));
 
         if (!cb_ctx || !cb_ctx->self) return;
+        if (cb_ctx->rtt) {
+            cb_ctx->rtt->Record(std::chrono::steady_clock::now() -
+                                cb_ctx->issued);
+        }
 
+        // Never throw on the CA thread: a failure goes to on_error
+        CAPV* self = cb_ctx->self;
         if (args.status != ECA_NORMAL) {
-            throw std::runtime_error(
-                "get callback is called without ECA_NORMAL status");
+            cb_ctx->error =
+                std::string("get failed: ") + ca_message(args.status);
+        } else {
+            try {
+                PVData sample = DecodePVData(args.type, args.count, args.dbr);
+                if constexpr (std::is_same_v<T, PVData>) {
+                    // Don't need convert
+                    cb_ctx->value = std::move(sample);
+                } else {
+                    // Convert to sample data
+                    cb_ctx->value = self->template Convert<T>(sample);
+                }
+            } catch (const std::exception& e) {
+                cb_ctx->error = e.what();
+            }
         }
-        PVData sample = DecodePVScalar(args.type, args.dbr);
+        const bool failed = !cb_ctx->error.empty();
+        if (failed && !cb_ctx->on_error) {
+            self->Report(cb_ctx->error);
+            self->ReleaseCompletion();
+            return;
+        }
+        self->PostCompletion(&RunGetCB<T>, cb_ctx.release(), failed);
+    }
 
-        if constexpr (std::is_same_v<T, PVData>) {
-            // Don't need convert
-            cb_ctx->cb(sample);
-        } else {
-            // Convert to sample data
-            cb_ctx->cb(extract_as<T>(sample));
+    // Dispatcher tasks; run == false only releases the request. The slot
+    // goes back to the pool before the callback runs, so a requester that
+    // was answered never sees its request in flight.
+    template <typename T>
+    static void RunGetCB(void* arg, uintptr_t failed, bool run) {
+        PooledRequest<GetCBCtxAs<T>> cb_ctx(static_cast<GetCBCtxAs<T>*>(arg));
+        if (!run) return;
+        if (failed) {
+            GetErrorCallback on_error = std::move(cb_ctx->on_error);
+            std::shared_ptr<RequestToken> token = std::move(cb_ctx->token);
+            std::string error = std::move(cb_ctx->error);
+            cb_ctx.reset();
+            RequestToken::Invoke(token.get(), [&] { on_error(error); });
+            return;
         }
+        GetCallbackAs<T> cb = std::move(cb_ctx->cb);
+        std::shared_ptr<RequestToken> token = std::move(cb_ctx->token);
+        T value = std::move(cb_ctx->value);
+        cb_ctx.reset();
+        RequestToken::Invoke(token.get(), [&] { cb(std::move(value)); });
     }
+    static void RunPutCB(void* arg, uintptr_t success, bool run);
+    static void RunConnCBs(void* arg, uintptr_t, bool run);
+    static void RunMonitorCBs(void* arg, uintptr_t, bool run);
 
     template <typename T>
     static T extract_as(const PVData& d) {
-        // Try exact type first
-        if (const auto* pv = std::get_if<PVScalarValue>(&d.value)) {
-            if (const auto* exact = std::get_if<T>(pv)) {
-                return *exact;
-            }
-            // Numeric scalar cast support (e.g., stored as double -> T=int32_t)
-            if constexpr (std::is_same_v<T, int32_t> ||
-                          std::is_same_v<T, float> ||
-                          std::is_same_v<T, double> ||
-                          std::is_same_v<T, uint16_t>) {
-                return std::visit(
-                    [](const auto& val) -> T {
-                        using S = std::decay_t<decltype(val)>;
-                        if constexpr (std::is_same_v<S, int32_t> ||
-                                      std::is_same_v<S, float> ||
-                                      std::is_same_v<S, double> ||
-                                      std::is_same_v<S, uint16_t>) {
-                            return static_cast<T>(val);
-                        } else {
-                            throw std::runtime_error("unsupported DBR type");
-                        }
-                    },
-                    *pv);
-            }
-            if constexpr (std::is_same_v<T, std::string>) {
-                if (const auto* s = std::get_if<std::string>(pv)) return *s;
+        return d.As<T>();
+    }
+
+    template <typename T>
+    T Convert(const PVData& d) const {
+        if constexpr (std::is_same_v<T, std::string>) {
+            if (d.Type() == PVType::kEnum && !d.IsArray()) {
+                return EnumLabel(d.As<uint16_t>());
             }
         }
-        // if (const auto* pa = std::get_if<ArrayValue>(&d.value)) {
-        //     if (const auto* exact = std::get_if<T>(pa)) {
-        //         return *exact;
-        //     }
-        //     // Optionally add numeric array cast if needed
-        // }
-        throw std::runtime_error("unsupported DBR type");
+        return extract_as<T>(d);
     }
+    std::string EnumLabel(uint16_t index) const;
 
-    // ---- decode helpers (TIME_ only for brevity) ----
-    static PVData DecodePVScalar(chtype type, const void* dbr);
+    // ---- decode helpers ----
     static chtype PreferredGetType(chtype dbf);
+    static const std::shared_ptr<const PVData>& EmptySnapshot();
 
     std::string pv_name_;
     chid chid_{nullptr};
     evid evid_{nullptr};
     bool connected_{false};
-    PVData pvdata_;
+    std::atomic<bool> has_value_{false};
+    std::atomic<uint64_t> value_updates_{0};
+    // Undecodable monitor updates are reported once per channel
+    std::atomic<bool> decode_error_reported_{false};
+
+    // Replaced wholesale by MonitorHandler; readers never take mtx_
+    std::shared_ptr<const PVData> snapshot_;
+    // Replaced wholesale by ControlHandler
+    std::shared_ptr<const PVControlInfo> control_info_;
+    evid control_evid_{nullptr};  // guarded by mtx_
 
     mutable std::mutex mtx_;
     std::shared_ptr<CAContextManager> ctx_;
 
-    std::vector<ConnCallback> conn_cbs_;
+    // Callback lists have their own locks, held while the callbacks run,
+    // so callbacks may read the PV state and CA threads never wait on them
+    std::mutex conn_cb_mtx_;
+    std::vector<std::pair<CallbackId, ConnCallback>> conn_cbs_;
+    // Connection changes merge into one queued event. conn_changes_ is
+    // guarded by mtx_, the delivered state by conn_cb_mtx_.
+    std::atomic<bool> conn_queued_{false};
+    uint64_t conn_changes_{0};
+    uint64_t conn_delivered_{0};
+    bool conn_reported_{false};
+    std::mutex monitor_cb_mtx_;
+    std::vector<std::pair<CallbackId, MonitorCallback>> monitor_cbs_;
+    // Rate limiting state
+    std::mutex rate_mtx_;
+    std::chrono::steady_clock::time_point last_notify_{};
+    bool notify_pending_{false};
+    std::atomic<bool> notify_queued_{false};
+    std::atomic<CallbackId> next_cb_id_{1};
+
+    // Guarded by mtx_; min_interval is mirrored for MonitorHandler
+    MonitorPolicy policy_;
+    bool monitor_requested_{false};
+    bool policy_set_{false};  // a user applied a policy
+    unsigned long monitor_mask_{0};  // mask of the active subscription
+    std::atomic<int64_t> min_interval_ns_{0};
 
+    // Guarded by mtx_; set on each connection
     chtype native_type_ = 0;
     size_t elem_count_ = 0;
+
+    // Completions reserved with the dispatcher and not yet posted
+    std::atomic<size_t> reservations_{0};
+
+    std::atomic<LatencyHistogram*> get_rtt_hist_{nullptr};
+    std::atomic<LatencyHistogram*> put_rtt_hist_{nullptr};
+    std::atomic<LatencyHistogram*> connect_hist_{nullptr};
+    // Set by Connect(), cleared on the first CONN_UP (guarded by mtx_)
+    std::chrono::steady_clock::time_point connect_started_;
+    bool connect_pending_{false};
 };
 
 }  // namespace bchtree::epics::ca
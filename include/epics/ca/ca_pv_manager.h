@@ -1,29 +1,129 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "epics/ca/ca_context_manager.h"
 #include "epics/ca/ca_pv.h"
 
 namespace bchtree::epics::ca {
 
+// Keeps channels connected after their last user releases them, so a
+// later tree run or reload that asks for the same name skips the CA search.
+// Idle channels are closed once they have been unused for max_idle or when
+// more than max_channels are idle (least recently released first). The
+// default (max_channels == 0) closes a channel as soon as it is released.
+// Limits are enforced by PVManager::CollectGarbage(), which the daemon
+// calls between runs and BTRunner's tick loop via CollectGarbageIfDue().
+struct LingerPolicy {
+    size_t max_channels = 0;
+    std::chrono::milliseconds max_idle{std::chrono::minutes(10)};
+};
+
+struct PVManagerStats {
+    uint64_t hits = 0;         // channel was in use by another owner
+    uint64_t linger_hits = 0;  // idle channel handed out again
+    uint64_t misses = 0;       // new channel created
+    uint64_t evictions = 0;    // idle channels closed by the policy
+    size_t lingering = 0;      // idle channels currently kept open
+};
+
 class PVManager {
    public:
     explicit PVManager(std::shared_ptr<CAContextManager> ctx)
         : ctx_(std::move(ctx)) {}
 
-    std::shared_ptr<CAPV> Get(const std::string& pv_name);
+    // Applies to channels handed out after the call
+    void SetLingerPolicy(const LingerPolicy& policy);
+    LingerPolicy GetLingerPolicy() const;
+    // Initial monitor policy of channels created after the call; nodes can
+    // only widen it per channel
+    void SetDefaultMonitorPolicy(const MonitorPolicy& policy);
 
-    void Remove(const std::string& pv_name);
+    // Hash used to pick the shard and bucket; callers that look up the same
+    // name repeatedly can compute it once and use the two-argument Get().
+    static size_t Hash(std::string_view pv_name);
+
+    std::shared_ptr<CAPV> Get(std::string_view pv_name);
+    std::shared_ptr<CAPV> Get(std::string_view pv_name, size_t hash);
+    // Create and connect all channels with a single flush. The returned
+    // handles keep the channels alive until the caller releases them.
+    std::vector<std::shared_ptr<CAPV>> Prewarm(
+        const std::vector<std::string>& pv_names);
+
+    void Remove(std::string_view pv_name);
     void Shutdown();
+    // Drops released channels and applies the linger policy to idle ones.
+    // Returns the number of registry entries removed.
     size_t CollectGarbage();
+    // CollectGarbage() at most once per kCollectInterval, or per max_idle
+    // (at least 10 ms) if shorter; otherwise returns 0 without taking any
+    // lock. Safe to call on every tick from several threads.
+    size_t CollectGarbageIfDue();
     size_t RegistrySize() const;
+    PVManagerStats Stats() const;
+
+    static constexpr std::chrono::milliseconds kCollectInterval{1000};
 
    private:
+    static constexpr size_t kShardCount = 16;
+
+    // Owns the CAPV. Pointers handed out by Get() share a lease whose
+    // deleter marks the channel idle (or closes it when not lingering);
+    // a new lease is issued when an idle channel is requested again.
+    struct Channel {
+        std::mutex mtx;
+        std::shared_ptr<CAPV> pv;
+        std::weak_ptr<CAPV> lease;
+        // Bumped per lease so a stale deleter leaves a newer lease alone
+        uint64_t generation = 0;
+        bool linger = false;
+        std::chrono::steady_clock::time_point released;
+    };
+
+    struct Entry {
+        std::string name;
+        std::shared_ptr<Channel> channel;
+    };
+
+    // Buckets are keyed by the precomputed hash so lookups by string_view
+    // never construct a std::string; collisions are resolved by name.
+    struct IdentityHash {
+        size_t operator()(size_t h) const noexcept { return h; }
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mtx;
+        std::unordered_multimap<size_t, Entry, IdentityHash> registry;
+    };
+
+    Shard& ShardFor(size_t hash) { return shards_[hash % kShardCount]; }
+
+    // Hands out a new lease on channel; caller holds the shard exclusively
+    std::shared_ptr<CAPV> Lease(const std::shared_ptr<Channel>& channel);
+    // Closes idle channels past the policy limits; takes every shard lock
+    size_t EvictIdle();
+
     std::shared_ptr<CAContextManager> ctx_;
-    mutable std::mutex mtx_;
-    std::unordered_map<std::string, std::weak_ptr<CAPV>> registry_;
+    std::array<Shard, kShardCount> shards_;
+
+    mutable std::mutex policy_mtx_;
+    LingerPolicy policy_;
+    MonitorPolicy default_monitor_;
+    std::atomic<bool> linger_enabled_{false};
+    // steady_clock time of the next CollectGarbageIfDue() run, in ns
+    std::atomic<int64_t> next_collect_ns_{0};
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> linger_hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
 };
 
 }  // namespace bchtree::epics::ca
@@ -0,0 +1,177 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics.h"
+
+namespace bchtree::epics::ca {
+
+class CAContextManager;
+
+// Where CA events reach user code (CAPV connection, monitor, get and put
+// callbacks).
+struct DispatchPolicy {
+    enum class Mode {
+        kInline,   // on the CA thread that received the event
+        kWorkers,  // on dispatcher threads
+        kTick,     // on tick threads, via CallbackDispatcher::Drain()
+    };
+    Mode mode = Mode::kInline;
+    size_t workers = 1;
+    // Ring size per worker (or in total for kTick); rings never grow.
+    // Connection and monitor events may fill half of a ring, the rest is
+    // kept for get and put completions.
+    size_t capacity = 4096;
+
+    // "inline", "tick" or a worker count; throws std::invalid_argument
+    static DispatchPolicy Parse(const std::string& spec);
+};
+
+struct DispatchStats {
+    uint64_t posted = 0;     // events queued
+    uint64_t executed = 0;   // queued events delivered
+    uint64_t deferred = 0;   // state events held back by a full ring
+    uint64_t rejected = 0;   // requests refused for lack of ring room
+    uint64_t cancelled = 0;  // dropped with their channel
+    size_t depth = 0;        // currently queued
+    size_t high_water = 0;   // largest ring depth seen
+};
+
+// Moves CA events off CA's auxiliary threads so a slow callback cannot
+// stall CA traffic. Each worker drains its own fixed-size ring fed by all
+// CA threads; events of one owner (a CAPV) always go to the same ring, so
+// they are never delivered concurrently. In tick mode there is a single
+// ring, drained by whichever tick thread gets to it first.
+//
+// Posting never blocks a CA thread. A get or put reserves room for its
+// completion when it is issued, and is refused if the ring has none.
+// Connection and monitor events carry no data of their own: owners keep
+// at most one of each queued and deliver their latest state with it.
+// When their half of the ring is full they wait, in order, in a side
+// queue that is bounded by the number of owners. They may therefore be
+// delivered after a later completion of the same owner; events of each
+// kind stay in order.
+class CallbackDispatcher {
+   public:
+    // Delivers the event (run = true) or only releases what arg holds
+    using TaskFn = void (*)(void* arg, uintptr_t data, bool run);
+
+    explicit CallbackDispatcher(CAContextManager& ctx) : ctx_(ctx) {}
+    ~CallbackDispatcher();
+
+    CallbackDispatcher(const CallbackDispatcher&) = delete;
+    CallbackDispatcher& operator=(const CallbackDispatcher&) = delete;
+
+    // Delivers queued events, then switches mode. Set before channels are
+    // created.
+    void SetPolicy(const DispatchPolicy& policy);
+    DispatchPolicy GetPolicy() const;
+
+    // Queues a state (connection or monitor) event, or delivers it now
+    // when dispatching is inline
+    void Post(const void* owner, TaskFn fn, void* arg, uintptr_t data = 0);
+    // Ring room for one completion of owner, taken before the request is
+    // issued; false if the ring is full. Always true when inline.
+    bool Reserve(const void* owner);
+    // Returns reservations whose completion will never be posted
+    void Unreserve(const void* owner, size_t count = 1);
+    // Queues a completion into the room taken by Reserve()
+    void PostReserved(const void* owner, TaskFn fn, void* arg,
+                      uintptr_t data = 0);
+    // Drops owner's queued events and waits until none of its events is
+    // being delivered. May be called from one of owner's own events.
+    void Cancel(const void* owner);
+
+    // Tick mode: delivers up to max queued events on the calling thread
+    // and returns how many. Returns 0 if another thread is draining.
+    size_t Drain(size_t max = SIZE_MAX);
+    // Tick mode: true once an event is queued and no other thread is
+    // draining, false after timeout
+    bool WaitForEvents(std::chrono::milliseconds timeout);
+
+    DispatchStats Stats() const;
+
+   private:
+    struct Task {
+        const void* owner = nullptr;
+        TaskFn fn = nullptr;
+        void* arg = nullptr;
+        uintptr_t data = 0;
+        std::chrono::steady_clock::time_point queued;
+        bool state = false;  // posted by Post(), not PostReserved()
+    };
+
+    // MPSC ring: CA threads push, one consumer pops
+    struct Shard {
+        std::mutex mtx;
+        std::condition_variable ready;     // an event was queued
+        std::condition_variable finished;  // an event was delivered
+        std::vector<Task> ring;
+        size_t head = 0;
+        size_t size = 0;
+        size_t states = 0;    // state events in the ring
+        size_t reserved = 0;  // room held for completions not yet posted
+        // State events waiting for their half of the ring, in order
+        std::deque<Task> deferred;
+        const void* running = nullptr;  // owner of the event in delivery
+        bool stop = false;
+        std::thread worker;
+        std::mutex drain_mtx;  // single consumer in tick mode
+        bool draining = false;  // a tick thread holds drain_mtx
+    };
+
+    Shard& ShardFor(const void* owner) const;
+    // Queues task unless dispatching is inline or stopping, in which case
+    // it is delivered on the calling thread
+    void Queue(Task task, bool reserved);
+    // Puts task into the ring or the side queue; shard.mtx is held.
+    // False if the shard is stopping.
+    bool Enqueue(Shard& shard, const Task& task, bool reserved);
+    // Moves deferred state events into the ring while there is room
+    static void Refill(Shard& shard);
+    // Ring slots state events may occupy
+    static size_t StateRoom(const Shard& shard) {
+        return std::max<size_t>(shard.ring.size() / 2, 1);
+    }
+    static bool Pending(const Shard& shard) {
+        return shard.size > 0 || !shard.deferred.empty();
+    }
+    // Pops and delivers one event; lock is held on entry and on return
+    void DeliverOne(Shard& shard, std::unique_lock<std::mutex>& lock);
+    void RunWorker(Shard& shard);
+    // Tick shard, or null unless the mode is kTick
+    Shard* TickShard() const;
+    // Delivers what is queued and joins the workers
+    void StopShards(std::vector<std::unique_ptr<Shard>>& shards);
+    // "ca_dispatch_wait" histogram; null when the context has no metrics
+    LatencyHistogram* WaitHistogram();
+
+    CAContextManager& ctx_;
+
+    // Shared by Post()/Cancel(), exclusive while switching policy
+    mutable std::shared_mutex policy_mtx_;
+    DispatchPolicy policy_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    // Replaced shards stay allocated in case a tick thread still holds one
+    std::vector<std::unique_ptr<Shard>> retired_;
+
+    std::atomic<uint64_t> posted_{0};
+    std::atomic<uint64_t> executed_{0};
+    std::atomic<uint64_t> deferred_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> cancelled_{0};
+    std::atomic<size_t> high_water_{0};
+    std::atomic<LatencyHistogram*> wait_hist_{nullptr};
+};
+
+}  // namespace bchtree::epics::ca
@@ -0,0 +1,21 @@
+#pragma once
+#include <cadef.h>
+#include <db_access.h>
+
+#include "epics/types.h"
+
+namespace bchtree::epics::ca {
+
+// Decodes any plain, STS, TIME, GR or CTRL DBR buffer (DBR_STRING ..
+// DBR_CTRL_DOUBLE) into PVData and fills PVMeta from the status, severity
+// and, for TIME types, the timestamp. The value decodes as an array when
+// as_array is set, as a scalar otherwise. DBR_CHAR arrays keep their bytes
+// and read as a long string through PVData::As<std::string>().
+// Throws std::runtime_error for other types.
+PVData DecodeDbr(chtype type, long count, const void* dbr, bool as_array);
+
+// Properties of a DBR_GR_* or DBR_CTRL_* buffer (value and status are
+// ignored). Throws std::runtime_error for other types.
+PVControlInfo DecodeControlInfo(chtype type, const void* dbr);
+
+}  // namespace bchtree::epics::ca
@@ -0,0 +1,41 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace bchtree::epics::ca {
+
+class CAContextManager;
+class CAPV;
+
+// Delivers the trailing monitor notification of rate-limited channels.
+// A CAPV whose update arrived inside its min_interval schedules itself
+// here, and its monitor callbacks run once more at the due time. The
+// worker thread starts on first use and is attached to the CA context.
+class MonitorCoalescer {
+   public:
+    explicit MonitorCoalescer(CAContextManager& ctx) : ctx_(ctx) {}
+    ~MonitorCoalescer();
+
+    MonitorCoalescer(const MonitorCoalescer&) = delete;
+    MonitorCoalescer& operator=(const MonitorCoalescer&) = delete;
+
+    // Keeps the earlier due time if pv is already scheduled
+    void Schedule(CAPV* pv, std::chrono::steady_clock::time_point due);
+    // Once this returns, pv is not being flushed and will not be
+    void Cancel(CAPV* pv);
+
+   private:
+    void Run();
+
+    CAContextManager& ctx_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::unordered_map<CAPV*, std::chrono::steady_clock::time_point> pending_;
+    std::thread worker_;
+    bool stop_{false};
+};
+
+}  // namespace bchtree::epics::ca
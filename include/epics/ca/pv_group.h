@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "epics/ca/ca_pv.h"
+#include "epics/ca/ca_pv_manager.h"
+#include "epics/ca/pv_handle.h"
+
+namespace bchtree::epics::ca {
+
+// A node's references to an ordered list of CAPVs (e.g. for CAGetMulti).
+// Each entry is a PVHandle, so re-resolving an unchanged list is cheap and
+// the connection callback follows the channels.
+class PVGroup {
+   public:
+    PVGroup(std::shared_ptr<PVManager> pv_manager, ConnCallback on_conn)
+        : pv_manager_(std::move(pv_manager)), on_conn_(std::move(on_conn)) {}
+
+    PVGroup(const PVGroup&) = delete;
+    PVGroup& operator=(const PVGroup&) = delete;
+
+    // Returns true if the list changed
+    bool Resolve(const std::vector<std::string>& names);
+
+    size_t Size() const { return handles_.size(); }
+    CAPV& operator[](size_t i) const { return *handles_[i]->Get(); }
+    const std::string& Name(size_t i) const { return handles_[i]->Name(); }
+
+    // Starts connecting channels that are not connected; true once all are
+    bool ConnectAll();
+
+    // "MAG:PS{}:CUR" with range "1..3" gives MAG:PS1:CUR .. MAG:PS3:CUR.
+    // Leading zeros on the first bound ("01..12") set the field width.
+    // Throws std::invalid_argument on a malformed pattern or range.
+    static std::vector<std::string> ExpandPattern(const std::string& pattern,
+                                                  const std::string& range);
+
+   private:
+    std::shared_ptr<PVManager> pv_manager_;
+    ConnCallback on_conn_;
+    std::vector<std::unique_ptr<PVHandle>> handles_;
+};
+
+}  // namespace bchtree::epics::ca
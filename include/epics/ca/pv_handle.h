@@ -0,0 +1,72 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "epics/ca/ca_pv.h"
+#include "epics/ca/ca_pv_manager.h"
+
+namespace bchtree::epics::ca {
+
+// A node's reference to a CAPV in PVManager. The name and its hash are
+// interned once; Resolve() only touches PVManager when the name changes and
+// moves the owner's callbacks to the new channel. Callbacks are removed
+// when the handle is destroyed, so the owner must outlive it. The same
+// holds for completions of requests issued through the handle, which the
+// channel may deliver after the owner is gone if it lingers. Owners
+// declare it after the members its callbacks use (usually last), so the
+// callbacks are removed before any of those is destroyed.
+class PVHandle {
+   public:
+    PVHandle(std::shared_ptr<PVManager> pv_manager, ConnCallback on_conn,
+             MonitorCallback on_monitor);
+    ~PVHandle();
+
+    PVHandle(const PVHandle&) = delete;
+    PVHandle& operator=(const PVHandle&) = delete;
+    PVHandle(PVHandle&&) = delete;
+    PVHandle& operator=(PVHandle&&) = delete;
+
+    // Returns true if the handle now points to a different channel
+    bool Resolve(std::string_view pv_name);
+    // Merged into the current channel and every channel resolved later
+    void SetMonitorPolicy(const MonitorPolicy& policy);
+
+    bool IsResolved() const { return pv_ != nullptr; }
+    const std::string& Name() const { return name_; }
+    const std::shared_ptr<CAPV>& Get() const { return pv_; }
+    CAPV* operator->() const { return pv_.get(); }
+
+    // Requests on the current channel; completions are dropped once the
+    // handle is destroyed
+    template <typename T>
+    bool GetCBAs(GetCallbackAs<T> cb, std::chrono::milliseconds timeout,
+                 GetErrorCallback on_error = nullptr) {
+        return pv_->GetCBAs<T>(std::move(cb), timeout, token_,
+                               std::move(on_error));
+    }
+    template <typename V>
+    bool PutCB(const V& value, PutCallback cb) {
+        return pv_->PutCB(value, std::move(cb), token_);
+    }
+
+   private:
+    void Release();
+
+    std::shared_ptr<PVManager> pv_manager_;
+    ConnCallback on_conn_;
+    MonitorCallback on_monitor_;
+    std::optional<MonitorPolicy> monitor_policy_;
+    // Shared with the handle's in-flight requests
+    std::shared_ptr<RequestToken> token_;
+
+    std::string name_;
+    size_t hash_{0};
+    std::shared_ptr<CAPV> pv_;
+    CallbackId conn_cb_id_{0};
+    CallbackId monitor_cb_id_{0};
+};
+
+}  // namespace bchtree::epics::ca
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bchtree::epics::ca {
+
+// Free list of reusable CA request contexts. Slots are allocated in chunks
+// and never returned to the heap, so once the pool has grown to the peak
+// number of in-flight requests, Acquire()/Release() do not allocate.
+// Acquire() runs on the issuing thread and Release() on the CA callback
+// thread; both take a short lock.
+template <typename Ctx>
+class RequestPool {
+   public:
+    static constexpr size_t kChunkSize = 64;
+
+    // Process-wide pool per context type. Intentionally leaked so a late
+    // CA callback during static destruction still finds it.
+    static RequestPool& Instance() {
+        static auto* pool = new RequestPool();
+        return *pool;
+    }
+
+    Ctx* Acquire() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (free_.empty()) Grow();
+        Ctx* ctx = free_.back();
+        free_.pop_back();
+        return ctx;
+    }
+
+    // Resets the slot so captured state is dropped before reuse
+    void Release(Ctx* ctx) {
+        if (!ctx) return;
+        *ctx = Ctx{};
+        std::lock_guard<std::mutex> lock(mtx_);
+        free_.push_back(ctx);
+    }
+
+    size_t Capacity() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return chunks_.size() * kChunkSize;
+    }
+
+    size_t InFlight() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return chunks_.size() * kChunkSize - free_.size();
+    }
+
+   private:
+    RequestPool() = default;
+
+    void Grow() {
+        chunks_.push_back(std::make_unique<Ctx[]>(kChunkSize));
+        // Keep room for every slot so Release() never reallocates
+        free_.reserve(chunks_.size() * kChunkSize);
+        Ctx* chunk = chunks_.back().get();
+        for (size_t i = kChunkSize; i > 0; --i) free_.push_back(&chunk[i - 1]);
+    }
+
+    mutable std::mutex mtx_;
+    std::vector<std::unique_ptr<Ctx[]>> chunks_;
+    std::vector<Ctx*> free_;
+};
+
+// unique_ptr deleter that hands the slot back to its pool
+template <typename Ctx>
+struct RequestPoolReleaser {
+    void operator()(Ctx* ctx) const {
+        RequestPool<Ctx>::Instance().Release(ctx);
+    }
+};
+
+template <typename Ctx>
+using PooledRequest = std::unique_ptr<Ctx, RequestPoolReleaser<Ctx>>;
+
+template <typename Ctx>
+PooledRequest<Ctx> AcquireRequest() {
+    return PooledRequest<Ctx>(RequestPool<Ctx>::Instance().Acquire());
+}
+
+}  // namespace bchtree::epics::ca
@@ -1,9 +1,15 @@
 #pragma once
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
@@ -22,20 +28,318 @@ using PVArrayValue =
                  std::vector<float>,       // DBF_FLOAT
                  std::vector<double>,      // DBF_DOUBLE
                  std::vector<uint16_t>,    // DBF_ENUM array (rare)
-                 std::vector<std::string>  // DBF_STRING
+                 std::vector<std::string>,  // DBF_STRING
+                 std::vector<uint8_t>       // DBF_CHAR (bytes, long strings)
                  >;
 
+template <typename T>
+struct is_vector : std::false_type {};
+template <typename T>
+struct is_vector<std::vector<T>> : std::true_type {};
+template <typename T>
+inline constexpr bool is_vector_v = is_vector<T>::value;
+
 struct PVMeta {
     uint32_t severity = 0;
     uint32_t status = 0;
     std::chrono::system_clock::time_point timestamp{};
 };
 
-struct PVData {
-    std::variant<PVScalarValue, PVArrayValue> value;
-    // PVScalarValue value;
+// Channel properties from a DBR_CTRL_* read: units, precision, display,
+// alarm, warning and control (DRVL/DRVH) limits, and enum state strings.
+// Fields a record type does not have stay at their defaults.
+struct PVControlInfo {
+    std::string units;
+    int16_t precision = 0;
+    double display_low = 0.0;
+    double display_high = 0.0;
+    double alarm_low = 0.0;
+    double alarm_high = 0.0;
+    double warning_low = 0.0;
+    double warning_high = 0.0;
+    double control_low = 0.0;
+    double control_high = 0.0;
+    std::vector<std::string> enum_strings;
+
+    // Records leave DRVL == DRVH (both 0) when there is no limit
+    bool HasControlLimits() const { return control_low < control_high; }
+    bool WithinControlLimits(double v) const {
+        return !HasControlLimits() || (v >= control_low && v <= control_high);
+    }
+
+    std::optional<uint16_t> EnumIndex(std::string_view state) const {
+        for (size_t i = 0; i < enum_strings.size(); ++i) {
+            if (enum_strings[i] == state) return static_cast<uint16_t>(i);
+        }
+        return std::nullopt;
+    }
+    // Empty if index has no state string
+    std::string_view EnumString(uint16_t index) const {
+        if (index >= enum_strings.size()) return {};
+        return enum_strings[index];
+    }
+};
+
+// Element type held by PVData; same order as the PVArrayValue alternatives
+// (scalar DBF_CHAR and DBF_SHORT values are held as kLong)
+enum class PVType : uint8_t {
+    kLong,
+    kFloat,
+    kDouble,
+    kEnum,
+    kString,
+    kChar,
+};
+
+// A channel value as delivered by CA. Numeric scalars and DBR strings (up
+// to MAX_STRING_SIZE chars) are stored inline; arrays are an immutable
+// payload shared between copies. Copying a PVData therefore never
+// allocates, and As<T>() reads scalars with a switch instead of visiting
+// variants. A default-constructed PVData reads as int32_t 0.
+class PVData {
+   public:
+    static constexpr size_t kMaxString = 40;  // MAX_STRING_SIZE
+
+    PVData() { u_.l = 0; }
+    ~PVData() { Reset(); }
+    PVData(const PVData& other) { Assign(other); }
+    PVData(PVData&& other) noexcept {
+        Assign(std::move(other));
+        other.Clear();
+    }
+    PVData& operator=(const PVData& other) {
+        if (this != &other) {
+            Reset();
+            Assign(other);
+        }
+        return *this;
+    }
+    PVData& operator=(PVData&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            Assign(std::move(other));
+            other.Clear();
+        }
+        return *this;
+    }
+
+    static PVData FromLong(int32_t v) { return PVData(PVType::kLong, v); }
+    static PVData FromFloat(float v) { return PVData(PVType::kFloat, v); }
+    static PVData FromDouble(double v) { return PVData(PVType::kDouble, v); }
+    static PVData FromEnum(uint16_t v) { return PVData(PVType::kEnum, v); }
+    // Copies up to kMaxString chars, stopping at the first NUL
+    static PVData FromString(const char* s, size_t max_len = kMaxString) {
+        PVData data;
+        data.type_ = PVType::kString;
+        data.len_ = 0;
+        const size_t n = max_len < kMaxString ? max_len : kMaxString;
+        while (data.len_ < n && s[data.len_] != '\0') {
+            data.u_.s[data.len_] = s[data.len_];
+            ++data.len_;
+        }
+        return data;
+    }
+    static PVData FromArray(PVArrayValue v) {
+        PVData data;
+        data.type_ = static_cast<PVType>(v.index());
+        new (&data.u_.array)
+            std::shared_ptr<const PVArrayValue>(
+                std::make_shared<const PVArrayValue>(std::move(v)));
+        data.is_array_ = true;
+        return data;
+    }
+
+    PVType Type() const { return type_; }
+    bool IsArray() const { return is_array_; }
+    // Scalar string contents; empty for other types
+    std::string_view StringView() const {
+        if (is_array_ || type_ != PVType::kString) return {};
+        return std::string_view(u_.s, len_);
+    }
+    // Shared array payload; null for scalars
+    const PVArrayValue* Array() const {
+        return is_array_ ? u_.array.get() : nullptr;
+    }
+
+    // Reads the value as T with numeric conversion. Arrays read as a
+    // scalar give their first element, scalars read as a vector give one
+    // element. Throws std::runtime_error if T cannot hold the value.
+    template <typename T>
+    T As() const {
+        if constexpr (is_vector_v<T>) {
+            return AsVector<T>();
+        } else {
+            return AsScalar<T>();
+        }
+    }
+
     PVMeta meta;
-    size_t count = 0;
+    uint32_t count = 0;
+
+   private:
+    // Packed after count so the whole value is 64 bytes
+    PVType type_ = PVType::kLong;
+    bool is_array_ = false;
+    uint8_t len_ = 0;
+
+    template <typename S>
+    PVData(PVType type, S v) : type_(type) {
+        if constexpr (std::is_same_v<S, int32_t>) u_.l = v;
+        if constexpr (std::is_same_v<S, float>) u_.f = v;
+        if constexpr (std::is_same_v<S, double>) u_.d = v;
+        if constexpr (std::is_same_v<S, uint16_t>) u_.e = v;
+    }
+
+    template <typename T, typename S>
+    static T Convert(S v) {
+        if constexpr (std::is_arithmetic_v<T>) {
+            return static_cast<T>(v);
+        } else {
+            throw std::runtime_error("unsupported DBR type");
+        }
+    }
+
+    template <typename T>
+    T AsScalar() const {
+        if (!is_array_) {
+            switch (type_) {
+                case PVType::kLong:
+                    return Convert<T>(u_.l);
+                case PVType::kFloat:
+                    return Convert<T>(u_.f);
+                case PVType::kDouble:
+                    return Convert<T>(u_.d);
+                case PVType::kEnum:
+                    return Convert<T>(u_.e);
+                case PVType::kString:
+                    if constexpr (std::is_same_v<T, std::string>) {
+                        return std::string(u_.s, len_);
+                    }
+                    break;
+                case PVType::kChar:
+                    break;
+            }
+            throw std::runtime_error("unsupported DBR type");
+        }
+        // Array PV read as scalar: use the first element
+        return std::visit(
+            [](const auto& arr) -> T {
+                using S = typename std::decay_t<decltype(arr)>::value_type;
+                if constexpr (std::is_same_v<S, uint8_t> &&
+                              std::is_same_v<T, std::string>) {
+                    // Char waveform holding a long string
+                    auto end = std::find(arr.begin(), arr.end(), '\0');
+                    return std::string(arr.begin(), end);
+                }
+                if (arr.empty()) {
+                    throw std::runtime_error("empty array value");
+                }
+                if constexpr (std::is_arithmetic_v<S> &&
+                              std::is_arithmetic_v<T>) {
+                    return static_cast<T>(arr.front());
+                } else if constexpr (std::is_same_v<S, T>) {
+                    return arr.front();
+                } else {
+                    throw std::runtime_error("unsupported DBR type");
+                }
+            },
+            *u_.array);
+    }
+
+    template <typename T>
+    T AsVector() const {
+        using E = typename T::value_type;
+
+        if (is_array_) {
+            if (const auto* exact = std::get_if<T>(u_.array.get())) {
+                return *exact;
+            }
+            // Numeric array cast support (e.g., stored as float -> T=double)
+            return std::visit(
+                [](const auto& arr) -> T {
+                    using S = typename std::decay_t<decltype(arr)>::value_type;
+                    if constexpr (std::is_arithmetic_v<S> &&
+                                  std::is_arithmetic_v<E>) {
+                        return T(arr.begin(), arr.end());
+                    } else {
+                        throw std::runtime_error("unsupported DBR type");
+                    }
+                },
+                *u_.array);
+        }
+        // Scalar PV read as array: one-element vector
+        if (type_ == PVType::kString) {
+            if constexpr (std::is_same_v<E, std::string>) {
+                return T{std::string(u_.s, len_)};
+            }
+            throw std::runtime_error("unsupported DBR type");
+        }
+        if constexpr (std::is_arithmetic_v<E>) {
+            return T{AsScalar<E>()};
+        }
+        throw std::runtime_error("unsupported DBR type");
+    }
+
+    void Reset() {
+        if (is_array_) {
+            u_.array.~shared_ptr();
+            is_array_ = false;
+        }
+    }
+
+    // Leaves a moved-from value reading as int32_t 0
+    void Clear() {
+        Reset();
+        type_ = PVType::kLong;
+        len_ = 0;
+        u_.l = 0;
+    }
+
+    // Caller has Reset() this
+    template <typename Other>
+    void Assign(Other&& other) {
+        meta = other.meta;
+        count = other.count;
+        type_ = other.type_;
+        len_ = other.len_;
+        if (other.is_array_) {
+            new (&u_.array) std::shared_ptr<const PVArrayValue>(
+                std::forward<Other>(other).u_.array);
+            is_array_ = true;
+            return;
+        }
+        switch (type_) {
+            case PVType::kLong:
+                u_.l = other.u_.l;
+                break;
+            case PVType::kFloat:
+                u_.f = other.u_.f;
+                break;
+            case PVType::kDouble:
+                u_.d = other.u_.d;
+                break;
+            case PVType::kEnum:
+                u_.e = other.u_.e;
+                break;
+            case PVType::kString:
+                std::memcpy(u_.s, other.u_.s, len_);
+                break;
+            case PVType::kChar:
+                break;
+        }
+    }
+
+    union Storage {
+        Storage() {}
+        ~Storage() {}
+        int32_t l;
+        float f;
+        double d;
+        uint16_t e;
+        char s[kMaxString];
+        std::shared_ptr<const PVArrayValue> array;
+    } u_;
+
 };
 
 }  // namespace bchtree::epics
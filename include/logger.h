@@ -1,33 +1,69 @@
 #pragma once
+#include <spdlog/async_logger.h>
+#include <spdlog/details/thread_pool.h>
 #include <spdlog/spdlog.h>
 
+#include <atomic>
 #include <string>
+#include <string_view>
 
 namespace bchtree {
+
+// What an async logger does when its queue is full:
+// block the caller, drop the oldest queued message, or (sample) drop the
+// oldest and also pass only every kSampleEvery-th debug/trace message once
+// the queue is half full.
+enum class LogOverflowPolicy { kBlock, kDrop, kSample };
+
 class Logger {
    public:
     void setConsoleLevel(const std::string& level);
     void setFileLevel(const std::string& level);
     void setFile(const std::string& path);
+    // Format and write on a background thread instead of the caller's.
+    // policy: (block|drop|sample); throws std::invalid_argument on another
+    // policy or a zero queue_size
+    void setAsync(size_t queue_size, const std::string& policy);
+    // Messages lost to a full queue, including sampledCount()
+    size_t droppedCount() const;
+    // Debug/trace messages skipped by the sample policy
+    size_t sampledCount() const;
+
+    // False when no sink keeps messages of this level; lets hot callers
+    // skip formatting them
+    bool should_log(spdlog::level::level_enum level);
 
     void info(const std::string& msg);
     void warn(const std::string& msg);
     void error(const std::string& msg);
-    void debug(const std::string& msg);
-    void trace(const std::string& msg);
+    // Views, so hot callers can log from a stack buffer
+    void debug(std::string_view msg);
+    void trace(std::string_view msg);
     void critical(const std::string& msg);
     void off(const std::string& msg);
     void flush();
 
    private:
+    static constexpr size_t kSampleEvery = 16;
+
     void ensure_init();
     void rebuild_logger();
+    bool should_sample();
     bool initialized_{false};
+    // Declared before logger_ so queued messages drain before it is gone
+    std::shared_ptr<spdlog::details::thread_pool> thread_pool_;
     std::shared_ptr<spdlog::logger> logger_;
     std::string file_path_;
 
+    bool async_{false};
+    size_t queue_size_{0};
+    LogOverflowPolicy overflow_policy_{LogOverflowPolicy::kBlock};
+    std::atomic<size_t> sample_counter_{0};
+    std::atomic<size_t> sampled_out_{0};
+
     spdlog::level::level_enum console_level_{spdlog::level::info};
     spdlog::level::level_enum file_level_{spdlog::level::debug};
     static spdlog::level::level_enum to_level(const std::string&);
+    static LogOverflowPolicy to_overflow_policy(const std::string&);
 };
 }  // namespace bchtree
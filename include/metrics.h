@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace bchtree {
+
+// HDR-style log-linear histogram of nanosecond latencies. Each power of two
+// is split into 8 linear sub-buckets (<= 12.5% relative error). Record() is
+// lock-free and may be called from CA callback threads.
+class LatencyHistogram {
+   public:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+    static constexpr size_t kBucketCount =
+        kSubBuckets + (64 - kSubBucketBits) * kSubBuckets;
+
+    void Record(uint64_t value_ns);
+    void Record(std::chrono::steady_clock::duration d);
+
+    uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t Sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t Min() const;
+    uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+    // Upper bound of the bucket holding the p-th percentile (0-100)
+    uint64_t Percentile(double p) const;
+
+    static size_t BucketIndex(uint64_t value);
+    static uint64_t BucketUpperBound(size_t index);
+
+   private:
+    std::array<std::atomic<uint64_t>, kBucketCount> counts_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_{UINT64_MAX};
+    std::atomic<uint64_t> max_{0};
+};
+
+// Histograms keyed by (family, label), e.g. ("ca_get_rtt", "<pv name>").
+// Returned pointers stay valid for the lifetime of the Metrics object, so
+// hot paths look them up once and cache them.
+class Metrics {
+   public:
+    LatencyHistogram* Get(const std::string& family, const std::string& label);
+
+    std::string ToJson() const;
+    std::string ToPrometheus() const;
+    // format: (json|prometheus); written to a temp file and renamed
+    bool WriteFile(const std::string& path, const std::string& format) const;
+
+    // Async-signal-safe; polled by the runner between ticks
+    void RequestDump() { dump_requested_.store(true); }
+    bool ConsumeDumpRequest() { return dump_requested_.exchange(false); }
+
+   private:
+    mutable std::mutex mtx_;
+    mutable std::mutex write_mtx_;
+    std::map<std::pair<std::string, std::string>,
+             std::unique_ptr<LatencyHistogram>>
+        histograms_;
+    std::atomic<bool> dump_requested_{false};
+};
+
+}  // namespace bchtree
@@ -0,0 +1,98 @@
+#pragma once
+#include <behaviortree_cpp/bt_factory.h>
+#include <behaviortree_cpp/loggers/abstract_logger.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bchtree {
+
+// Same text as BT::toStr(status, false) without allocating a std::string
+const char* StatusName(BT::NodeStatus status);
+
+// Fixed-size record; status fields hold BT::NodeStatus values.
+struct TraceRecord {
+    uint64_t seq;           // write index + 1; 0 means never written
+    uint64_t timestamp_ns;  // steady_clock
+    uint16_t node_uid;
+    uint8_t prev_status;
+    uint8_t status;
+};
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord layout changed");
+
+struct TraceFileHeader {
+    static constexpr char kMagic[8] = {'B', 'C', 'H', 'T', 'R', 'A', 'C', 'E'};
+    static constexpr uint32_t kVersion = 2;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    uint64_t start_ns;
+    std::atomic<uint64_t> write_index;
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "write_index must be lock-free to live in a shared mapping");
+
+// Flight recorder writing TraceRecords into a memory-mapped ring file.
+// Records survive a crash of the process; node names are written once to
+// "<path>.names" as "<uid>\t<full path>" lines.
+class TraceRecorder {
+   public:
+    TraceRecorder(const std::string& path, size_t capacity);
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    void Record(uint16_t node_uid, uint8_t prev_status, uint8_t status);
+    void WriteNodeNames(const BT::Tree& tree);
+
+   private:
+    std::string path_;
+    int fd_{-1};
+    size_t map_size_{0};
+    TraceFileHeader* header_{nullptr};
+    TraceRecord* records_{nullptr};
+};
+
+// Reads a ring file written by TraceRecorder, oldest record first.
+class TraceReader {
+   public:
+    explicit TraceReader(const std::string& path);
+
+    const std::vector<TraceRecord>& Records() const { return records_; }
+    uint64_t StartNs() const { return start_ns_; }
+    // Empty if the .names sidecar is missing
+    std::vector<std::string> NodeNames() const;
+
+   private:
+    std::string path_;
+    uint64_t start_ns_{0};
+    std::vector<TraceRecord> records_;
+};
+
+class TraceLogger : public BT::StatusChangeLogger {
+   public:
+    TraceLogger(const BT::Tree& tree, std::shared_ptr<TraceRecorder> recorder);
+    ~TraceLogger() override;
+
+    TraceLogger(const TraceLogger&) = delete;
+    TraceLogger& operator=(const TraceLogger&) = delete;
+    TraceLogger(TraceLogger&&) = delete;
+    TraceLogger& operator=(TraceLogger&&) = delete;
+
+    virtual void flush() override {}
+
+   private:
+    virtual void callback(BT::Duration timestamp, const BT::TreeNode& node,
+                          BT::NodeStatus prev_status,
+                          BT::NodeStatus status) override;
+
+    std::shared_ptr<TraceRecorder> recorder_;
+};
+
+}  // namespace bchtree
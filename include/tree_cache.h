@@ -0,0 +1,54 @@
+#pragma once
+#include <behaviortree_cpp/bt_factory.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace bchtree {
+
+// Keeps one factory per tree file with the XML already parsed and validated,
+// so repeated runs only instantiate nodes. An entry is rebuilt when the file
+// or any file it <include>s changes content. All trees share the node
+// registrations done by register_nodes; use one cache per set of node
+// dependencies (CA context and PVManager).
+class TreeCache {
+   public:
+    using RegisterFn = std::function<void(BT::BehaviorTreeFactory&)>;
+
+    explicit TreeCache(RegisterFn register_nodes)
+        : register_nodes_(std::move(register_nodes)) {}
+
+    BT::Tree CreateTree(const std::string& tree_path,
+                        const std::string& tree_id,
+                        BT::Blackboard::Ptr blackboard);
+
+    void Clear();
+    size_t Hits() const { return hits_.load(); }
+    size_t Misses() const { return misses_.load(); }
+
+    // (path, content hash) of tree_path and everything it includes
+    using Fingerprint = std::vector<std::pair<std::string, size_t>>;
+    static Fingerprint FingerprintOf(const std::string& tree_path);
+
+   private:
+    struct Entry {
+        Fingerprint fingerprint;
+        std::unique_ptr<BT::BehaviorTreeFactory> factory;
+        // createTree() is not guaranteed to be reentrant
+        std::mutex mtx;
+    };
+
+    RegisterFn register_nodes_;
+    std::mutex mtx_;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries_;
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> misses_{0};
+};
+
+}  // namespace bchtree
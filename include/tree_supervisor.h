@@ -0,0 +1,69 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bt_runner.h"
+#include "epics/ca/ca_context_manager.h"
+#include "epics/ca/ca_pv_manager.h"
+#include "logger.h"
+#include "metrics.h"
+
+namespace bchtree {
+
+// Loads and runs several trees concurrently in one process. All runners
+// share one CA context and PVManager, so a PV used by many trees has a
+// single channel and a single monitor subscription.
+class TreeSupervisor {
+   public:
+    TreeSupervisor(std::shared_ptr<epics::ca::CAContextManager> ctx,
+                   std::shared_ptr<epics::ca::PVManager> pv_manager)
+        : ctx_(std::move(ctx)), pv_manager_(std::move(pv_manager)) {}
+
+    // Returns the runner for further configuration (tick mode, globals...).
+    // The tree file is loaded on a worker thread by RunAll().
+    // The tree is named after the file stem, or "<parent dir>/<stem>" when
+    // several trees share a stem; throws std::invalid_argument if that
+    // still does not tell them apart.
+    BTRunner& AddTree(const std::string& tree_path);
+
+    // Logger and metrics are handed to runners in AddTree(); set them first
+    void SetLogger(std::shared_ptr<Logger> logger);
+    // Worker threads; trees beyond this count wait for a free worker.
+    // 0 (default) runs every tree on its own thread.
+    void SetThreadCount(size_t count);
+    // Shared by all runners; written once all trees finished and whenever
+    // Metrics::RequestDump() was called.
+    void SetMetrics(std::shared_ptr<Metrics> metrics, std::string path,
+                    std::string format);
+
+    // Returns true if every tree loaded and ended in SUCCESS
+    bool RunAll(
+        std::chrono::milliseconds sleep_time = std::chrono::milliseconds(10));
+    // Paths of trees that failed to load or ended in FAILURE
+    std::vector<std::string> FailedTrees() const;
+
+   private:
+    struct Entry {
+        std::string path;
+        std::unique_ptr<BTRunner> runner;
+        bool success{false};
+    };
+
+    void RunEntry(Entry& entry, std::chrono::milliseconds sleep_time);
+    void DumpMetrics();
+
+    std::shared_ptr<epics::ca::CAContextManager> ctx_;
+    std::shared_ptr<epics::ca::PVManager> pv_manager_;
+    std::shared_ptr<Logger> logger_;
+    size_t thread_count_{0};
+
+    std::shared_ptr<Metrics> metrics_;
+    std::string metrics_path_;
+    std::string metrics_format_;
+
+    std::vector<std::unique_ptr<Entry>> trees_;
+};
+
+}  // namespace bchtree
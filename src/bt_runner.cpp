@@ -2,13 +2,32 @@
 
 #include <behaviortree_cpp/loggers/bt_cout_logger.h>
 #include <behaviortree_cpp/xml_parsing.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <set>
+#include <thread>
 
 #include "actions/caget_node.h"
+#include "actions/camulti_node.h"
 #include "actions/caput_node.h"
+#include "actions/caput_verify_node.h"
+#include "actions/cawait_node.h"
 #include "actions/print_node.h"
 
 namespace bchtree {
 
+namespace {
+constexpr auto kRetiredTreeGrace = std::chrono::seconds(10);
+}  // namespace
+
+BTRunner::~BTRunner() {
+    if (inotify_fd_ >= 0) ::close(inotify_fd_);
+}
+
 void BTRunner::PrintTree() {
     if (!initialized_) {
         throw BT::RuntimeError("BTRunner: Runner is not initialized");
@@ -26,57 +45,336 @@ bool BTRunner::Run(std::chrono::milliseconds sleep_time) {
     }
 
     if (logger_) {
-        logger_->info("Start Tree:");
+        logger_->info("Start Tree:" + LogSuffix());
+    }
+
+    // Run() may be called from a worker thread
+    ctx_->EnsureAttached();
+
+    AttachLoggers();
+
+    const BT::NodeStatus status = TickWhileRunning(
+        (tick_mode_ == TickMode::kEvent) ? max_idle_ : sleep_time);
+
+    if (logger_) {
+        logger_->info(std::string("End Tree: status=") + toStr(status) +
+                      LogSuffix());
     }
 
+    DumpMetrics();
+
+    return status == BT::NodeStatus::SUCCESS;
+}
+
+void BTRunner::AttachLoggers() {
     if (use_runner_logger_) {
         runner_logger_ = std::make_unique<RunnerLogger>(tree_, logger_);
     }
 
-    const BT::NodeStatus status = tree_.tickWhileRunning(sleep_time);
+    if (trace_recorder_) {
+        trace_logger_ = std::make_unique<TraceLogger>(tree_, trace_recorder_);
+    }
 
-    if (logger_) {
-        logger_->info(std::string("End Tree: status=") + toStr(status));
+    if (metrics_) {
+        node_metrics_logger_ = std::make_unique<NodeMetricsLogger>(
+            tree_, *metrics_, tree_name_.empty() ? "" : tree_name_ + "/");
+        tick_histogram_ = metrics_->Get("tick", tree_name_);
     }
+}
 
-    return status == BT::NodeStatus::SUCCESS;
+void BTRunner::DetachLoggers() {
+    runner_logger_.reset();
+    trace_logger_.reset();
+    node_metrics_logger_.reset();
+}
+
+BT::NodeStatus BTRunner::TickOnceBatched() {
+    // All CA requests issued by nodes during this tick go out in one flush
+    epics::ca::IOBatch batch(*ctx_);
+    if (!tick_histogram_) return tree_.tickOnce();
+
+    const auto start = std::chrono::steady_clock::now();
+    const BT::NodeStatus status = tree_.tickOnce();
+    tick_histogram_->Record(std::chrono::steady_clock::now() - start);
+    return status;
+}
+
+BT::NodeStatus BTRunner::TickWhileRunning(
+    std::chrono::milliseconds sleep_time) {
+    // With tick dispatch, CA callbacks are queued and run here between
+    // ticks, so the queue rather than the nodes signals new events
+    auto& dispatcher = ctx_->Dispatcher();
+    const bool drain = dispatcher.GetPolicy().mode ==
+                       epics::ca::DispatchPolicy::Mode::kTick;
+
+    if (drain) dispatcher.Drain();
+    BT::NodeStatus status = TickOnceBatched();
+    while (status == BT::NodeStatus::RUNNING) {
+        // Wakes as soon as any node calls emitWakeUpSignal(); in event mode
+        // sleep_time is max_idle_ and only bounds how late a node timeout
+        // can be noticed.
+        if (drain) {
+            dispatcher.WaitForEvents(sleep_time);
+            dispatcher.Drain();
+        } else {
+            tree_.sleep(sleep_time);
+        }
+        if (metrics_ && metrics_->ConsumeDumpRequest()) DumpMetrics();
+        if (hot_reload_) PollHotReload();
+        // Closes lingering channels idle past the linger policy
+        pv_manager_->CollectGarbageIfDue();
+        status = TickOnceBatched();
+    }
+    return status;
+}
+
+void BTRunner::DumpMetrics() {
+    if (!metrics_ || metrics_path_.empty()) return;
+
+    if (!metrics_->WriteFile(metrics_path_, metrics_format_) && logger_) {
+        logger_->error("BTRunner: failed to write metrics to " +
+                       metrics_path_);
+    }
+}
+
+void BTRunner::SetTickMode(TickMode mode, std::chrono::milliseconds max_idle) {
+    tick_mode_ = mode;
+    max_idle_ = max_idle;
 }
 
 void BTRunner::SetLogger(std::shared_ptr<Logger> logger) { logger_ = logger; }
 
+void BTRunner::SetTreeName(std::string name) { tree_name_ = std::move(name); }
+
+std::string BTRunner::LogSuffix() const {
+    return tree_name_.empty() ? "" : " [" + tree_name_ + "]";
+}
+
 void BTRunner::SetGlobalBB(std::string key, std::string value) {
     globals_bb_map_[std::move(key)] = std::move(value);
 }
 
+void BTRunner::SetPrewarmWait(double min_ratio,
+                              std::chrono::milliseconds timeout) {
+    prewarm_min_ratio_ = std::clamp(min_ratio, 0.0, 1.0);
+    prewarm_timeout_ = timeout;
+}
+
+void BTRunner::SetMetrics(std::shared_ptr<Metrics> metrics, std::string path,
+                          std::string format) {
+    metrics_ = std::move(metrics);
+    metrics_path_ = std::move(path);
+    metrics_format_ = std::move(format);
+}
+
 void BTRunner::UseRunnerLogger() { use_runner_logger_ = true; }
 
+void BTRunner::UseTraceRecorder(const std::string& path, size_t capacity) {
+    trace_recorder_ = std::make_shared<TraceRecorder>(path, capacity);
+}
+
 void BTRunner::RegisterTreeFromFile(const std::string& treePath) {
+    // Nodes create channels while the tree is built
+    ctx_->EnsureAttached();
+
     blackboard_ = BT::Blackboard::create();
     for (const auto& [k, v] : globals_bb_map_) {
         blackboard_->set(k, v);
     }
 
-    factory_.registerNodeType<CAGetNode<epics::PVData>>("CAGet", ctx_,
-                                                        pv_manager_);
-    factory_.registerNodeType<CAGetNode<double>>("CAGetDouble", ctx_,
-                                                 pv_manager_);
-    factory_.registerNodeType<CAGetNode<int>>("CAGetInt", ctx_, pv_manager_);
-    factory_.registerNodeType<CAGetNode<std::string>>("CAGetString", ctx_,
-                                                      pv_manager_);
+    if (hot_reload_ && !tree_cache_) {
+        // Reloads rebuild through the cache, which tracks file changes
+        tree_cache_ = std::make_shared<TreeCache>(
+            [ctx = ctx_, pv_manager = pv_manager_](BT::BehaviorTreeFactory& f) {
+                RegisterNodes(f, ctx, pv_manager);
+            });
+    }
+
+    if (tree_cache_) {
+        tree_ = tree_cache_->CreateTree(treePath, "MainTree", blackboard_);
+    } else {
+        RegisterNodes(factory_, ctx_, pv_manager_);
+        factory_.registerBehaviorTreeFromFile(treePath);
+        tree_ = factory_.createTree("MainTree", blackboard_);
+    }
 
-    factory_.registerNodeType<CAPutNode<double>>("CAPutDouble", ctx_,
-                                                 pv_manager_);
-    factory_.registerNodeType<CAPutNode<int>>("CAPutInt", ctx_, pv_manager_);
-    factory_.registerNodeType<CAPutNode<std::string>>("CAPutString", ctx_,
-                                                      pv_manager_);
-    factory_.registerNodeType<PrintNode>("Print");
+    PrewarmPVs(true);
 
-    factory_.registerBehaviorTreeFromFile(treePath);
-    tree_ = factory_.createTree("MainTree", blackboard_);
+    tree_path_ = treePath;
+    if (hot_reload_) WatchTreeFiles();
 
     initialized_ = true;
 }
 
+void BTRunner::EnableHotReload() { hot_reload_ = true; }
+
+void BTRunner::WatchTreeFiles() {
+    if (inotify_fd_ < 0) {
+        inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd_ < 0) {
+            if (logger_) {
+                logger_->error("BTRunner: inotify unavailable, hot reload off");
+            }
+            hot_reload_ = false;
+            return;
+        }
+    }
+
+    tree_fingerprint_ = TreeCache::FingerprintOf(tree_path_);
+    for (const auto& [path, hash] : tree_fingerprint_) {
+        // Watch directories: editors often save by renaming a temp file
+        const auto dir = std::filesystem::path(path).parent_path().string();
+        ::inotify_add_watch(inotify_fd_, dir.c_str(),
+                            IN_CLOSE_WRITE | IN_MOVED_TO);
+    }
+}
+
+void BTRunner::PollHotReload() {
+    if (has_retired_tree_ &&
+        std::chrono::steady_clock::now() - retired_at_ > kRetiredTreeGrace) {
+        retired_tree_ = BT::Tree();
+        has_retired_tree_ = false;
+    }
+
+    // Drain events; which file changed is decided by the fingerprint
+    alignas(inotify_event) char buf[4096];
+    bool changed = false;
+    while (::read(inotify_fd_, buf, sizeof(buf)) > 0) changed = true;
+    if (!changed) return;
+
+    try {
+        if (TreeCache::FingerprintOf(tree_path_) == tree_fingerprint_) {
+            return;
+        }
+
+        // Build first: the new nodes resolve the channels the old ones
+        // still hold, so nothing disconnects
+        BT::Tree next =
+            tree_cache_->CreateTree(tree_path_, "MainTree", blackboard_);
+
+        tree_.haltTree();
+        DetachLoggers();
+        retired_tree_ = std::move(tree_);
+        retired_at_ = std::chrono::steady_clock::now();
+        has_retired_tree_ = true;
+        tree_ = std::move(next);
+        AttachLoggers();
+
+        PrewarmPVs(false);
+        WatchTreeFiles();
+
+        if (logger_) {
+            logger_->info("BTRunner: reloaded " + tree_path_ + LogSuffix());
+        }
+    } catch (const std::exception& e) {
+        // Typically a half-saved or invalid file; retried on the next event
+        if (logger_) {
+            logger_->error("BTRunner: reload of " + tree_path_ +
+                           " failed, keeping current tree: " + e.what());
+        }
+    }
+}
+
+void BTRunner::SetTreeCache(std::shared_ptr<TreeCache> cache) {
+    tree_cache_ = std::move(cache);
+}
+
+void BTRunner::RegisterNodes(
+    BT::BehaviorTreeFactory& factory,
+    const std::shared_ptr<epics::ca::CAContextManager>& ctx,
+    const std::shared_ptr<epics::ca::PVManager>& pv_manager) {
+    factory.registerNodeType<CAGetNode<epics::PVData>>("CAGet", ctx,
+                                                       pv_manager);
+    factory.registerNodeType<CAGetNode<double>>("CAGetDouble", ctx,
+                                                pv_manager);
+    factory.registerNodeType<CAGetNode<int>>("CAGetInt", ctx, pv_manager);
+    factory.registerNodeType<CAGetNode<std::string>>("CAGetString", ctx,
+                                                     pv_manager);
+    factory.registerNodeType<CAGetNode<std::vector<double>>>(
+        "CAGetDoubleArray", ctx, pv_manager);
+    factory.registerNodeType<CAGetNode<std::vector<int>>>("CAGetIntArray",
+                                                          ctx, pv_manager);
+    factory.registerNodeType<CAGetNode<std::vector<std::string>>>(
+        "CAGetStringArray", ctx, pv_manager);
+
+    factory.registerNodeType<CAPutNode<double>>("CAPutDouble", ctx,
+                                                pv_manager);
+    factory.registerNodeType<CAPutNode<int>>("CAPutInt", ctx, pv_manager);
+    factory.registerNodeType<CAPutNode<std::string>>("CAPutString", ctx,
+                                                     pv_manager);
+    factory.registerNodeType<CAPutNode<std::vector<double>>>(
+        "CAPutDoubleArray", ctx, pv_manager);
+    factory.registerNodeType<CAPutNode<std::vector<int>>>("CAPutIntArray",
+                                                          ctx, pv_manager);
+    factory.registerNodeType<CAPutVerifyNode<double>>("CAPutVerifyDouble",
+                                                      ctx, pv_manager);
+    factory.registerNodeType<CAPutVerifyNode<int>>("CAPutVerifyInt", ctx,
+                                                   pv_manager);
+    factory.registerNodeType<CAGetMultiNode<double>>("CAGetMultiDouble", ctx,
+                                                     pv_manager);
+    factory.registerNodeType<CAGetMultiNode<int>>("CAGetMultiInt", ctx,
+                                                  pv_manager);
+    factory.registerNodeType<CAGetMultiNode<std::string>>("CAGetMultiString",
+                                                          ctx, pv_manager);
+    factory.registerNodeType<CAPutMultiNode<double>>("CAPutMultiDouble", ctx,
+                                                     pv_manager);
+    factory.registerNodeType<CAPutMultiNode<int>>("CAPutMultiInt", ctx,
+                                                  pv_manager);
+    factory.registerNodeType<CAPutMultiNode<std::string>>("CAPutMultiString",
+                                                          ctx, pv_manager);
+
+    factory.registerNodeType<CAWaitNode<double>>("CAWaitDouble", ctx,
+                                                 pv_manager);
+    factory.registerNodeType<CAWaitNode<int>>("CAWaitInt", ctx, pv_manager);
+    factory.registerNodeType<CAWaitNode<std::string>>("CAWaitString", ctx,
+                                                      pv_manager);
+    factory.registerNodeType<PrintNode>("Print");
+}
+
+void BTRunner::PrewarmPVs(bool wait) {
+    // Collect literal pv ports; blackboard-remapped ones are resolved lazily
+    std::set<std::string> names;
+    tree_.applyVisitor([&names](BT::TreeNode* node) {
+        const auto& ports = node->config().input_ports;
+        for (const char* key : {"pv", "readback"}) {
+            auto it = ports.find(key);
+            if (it == ports.end() || it->second.empty() ||
+                BT::TreeNode::isBlackboardPointer(it->second)) {
+                continue;
+            }
+            names.insert(it->second);
+        }
+    });
+
+    prewarmed_pvs_ = pv_manager_->Prewarm({names.begin(), names.end()});
+
+    if (!wait || prewarmed_pvs_.empty() || prewarm_min_ratio_ <= 0.0) {
+        return;
+    }
+
+    const size_t needed = static_cast<size_t>(
+        std::ceil(prewarm_min_ratio_ * prewarmed_pvs_.size()));
+    const auto deadline = std::chrono::steady_clock::now() + prewarm_timeout_;
+
+    size_t connected = 0;
+    while (true) {
+        connected = std::count_if(
+            prewarmed_pvs_.begin(), prewarmed_pvs_.end(),
+            [](const auto& pv) { return pv->IsConnected(); });
+        if (connected >= needed ||
+            std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    if (logger_) {
+        logger_->info("Prewarm: " + std::to_string(connected) + "/" +
+                      std::to_string(prewarmed_pvs_.size()) +
+                      " PVs connected");
+    }
+}
+
 RunnerLogger::RunnerLogger(const BT::Tree& tree, std::shared_ptr<Logger> logger)
     : StatusChangeLogger(tree.rootNode()), logger_(std::move(logger)) {}
 RunnerLogger::~RunnerLogger() = default;
@@ -86,20 +384,52 @@ void RunnerLogger::callback(BT::Duration timestamp, const BT::TreeNode& node,
     // https://github.com/BehaviorTree/BehaviorTree.CPP/blob/master/src/loggers/bt_cout_logger.cpp
     using namespace std::chrono;
 
+    // Runs on every transition; skip formatting when debug is filtered
+    if (!logger_->should_log(spdlog::level::debug)) return;
+
     constexpr const char* whitespaces = "                         ";
     constexpr size_t ws_count = 25;
 
     const std::string& name = node.name();
     const char* padding = &whitespaces[std::min(ws_count, name.size())];
 
-    const std::string prev_str = BT::toStr(prev_status, /*colored=*/false);
-    const std::string curr_str = BT::toStr(status, /*colored=*/false);
-
     char buffer[256];
     std::snprintf(buffer, sizeof(buffer), " %s%s %s -> %s", name.c_str(),
-                  padding, prev_str.c_str(), curr_str.c_str());
+                  padding, StatusName(prev_status), StatusName(status));
     logger_->debug(buffer);
 }
 
 void RunnerLogger::flush() { logger_->flush(); }
+
+NodeMetricsLogger::NodeMetricsLogger(const BT::Tree& tree, Metrics& metrics,
+                                     const std::string& label_prefix)
+    : StatusChangeLogger(tree.rootNode()) {
+    // Resolve every histogram up front so callback() never takes a lock
+    tree.applyVisitor([&](const BT::TreeNode* node) {
+        const uint16_t uid = node->UID();
+        if (uid >= histograms_.size()) {
+            histograms_.resize(uid + 1, nullptr);
+            started_.resize(uid + 1);
+        }
+        histograms_[uid] =
+            metrics.Get("node_latency", label_prefix + node->fullPath());
+    });
+}
+NodeMetricsLogger::~NodeMetricsLogger() = default;
+
+void NodeMetricsLogger::callback(BT::Duration timestamp,
+                                 const BT::TreeNode& node,
+                                 BT::NodeStatus prev_status,
+                                 BT::NodeStatus status) {
+    const uint16_t uid = node.UID();
+    if (uid >= histograms_.size() || !histograms_[uid]) return;
+
+    if (status == BT::NodeStatus::RUNNING) {
+        started_[uid] = std::chrono::steady_clock::now();
+    } else if (prev_status == BT::NodeStatus::RUNNING &&
+               BT::isStatusCompleted(status)) {
+        histograms_[uid]->Record(std::chrono::steady_clock::now() -
+                                 started_[uid]);
+    }
+}
 }  // namespace bchtree
@@ -0,0 +1,323 @@
+#include "daemon_server.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace bchtree {
+
+namespace {
+
+constexpr size_t kMaxLineLength = 64 * 1024;
+
+std::vector<std::string> SplitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    std::string field;
+    std::istringstream iss(line);
+    while (std::getline(iss, field, '\t')) fields.push_back(field);
+    return fields;
+}
+
+void CheckField(const std::string& field) {
+    if (field.find_first_of("\t\n") != std::string::npos) {
+        throw std::invalid_argument("daemon field contains tab or newline: " +
+                                    field);
+    }
+}
+
+sockaddr_un MakeAddress(const std::string& socket_path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("socket path too long: " + socket_path);
+    }
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    return addr;
+}
+
+// Read up to and excluding '\n'; false on EOF, error or oversized line
+bool ReadLine(int fd, std::string& line) {
+    line.clear();
+    char c;
+    while (line.size() < kMaxLineLength) {
+        const ssize_t n = ::read(fd, &c, 1);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        if (c == '\n') return true;
+        line.push_back(c);
+    }
+    return false;
+}
+
+bool WriteAll(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t n =
+            ::send(fd, data.data() + written, data.size() - written,
+                   MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+}  // namespace
+
+std::string EncodeDaemonRequest(const DaemonRequest& request) {
+    CheckField(request.tree_path);
+    std::string line = "run\t" + request.tree_path;
+    for (const auto& [key, value] : request.globals) {
+        CheckField(key);
+        CheckField(value);
+        line += "\t" + key + "=" + value;
+    }
+    return line + "\n";
+}
+
+bool DecodeDaemonRequest(const std::string& line, DaemonRequest& request) {
+    const auto fields = SplitFields(line);
+    if (fields.size() < 2 || fields[0] != "run" || fields[1].empty()) {
+        return false;
+    }
+
+    request.tree_path = fields[1];
+    request.globals.clear();
+    for (size_t i = 2; i < fields.size(); ++i) {
+        const auto pos = fields[i].find('=');
+        if (pos == std::string::npos) return false;
+        request.globals.emplace_back(fields[i].substr(0, pos),
+                                     fields[i].substr(pos + 1));
+    }
+    return true;
+}
+
+std::string EncodeDaemonReply(const DaemonReply& reply) {
+    if (reply.status == "ERROR") {
+        std::string message = reply.error;
+        for (char& c : message) {
+            if (c == '\t' || c == '\n') c = ' ';
+        }
+        return "ERROR\t" + message + "\n";
+    }
+
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "\t%.3f\t%.3f\n", reply.load_ms,
+                  reply.run_ms);
+    return reply.status + buf;
+}
+
+bool DecodeDaemonReply(const std::string& line, DaemonReply& reply) {
+    const auto fields = SplitFields(line);
+    if (fields.empty()) return false;
+
+    reply = DaemonReply{};
+    reply.status = fields[0];
+    if (reply.status == "ERROR") {
+        reply.error = (fields.size() > 1) ? fields[1] : "";
+        return true;
+    }
+    if (fields.size() != 3 ||
+        (reply.status != "SUCCESS" && reply.status != "FAILURE")) {
+        return false;
+    }
+    try {
+        reply.load_ms = std::stod(fields[1]);
+        reply.run_ms = std::stod(fields[2]);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+DaemonServer::DaemonServer(
+    std::shared_ptr<epics::ca::CAContextManager> ctx,
+    std::shared_ptr<epics::ca::PVManager> pv_manager)
+    : ctx_(std::move(ctx)), pv_manager_(std::move(pv_manager)) {
+    tree_cache_ = std::make_shared<TreeCache>(
+        [ctx = ctx_, pv_manager = pv_manager_](BT::BehaviorTreeFactory& f) {
+            BTRunner::RegisterNodes(f, ctx, pv_manager);
+        });
+}
+
+DaemonServer::~DaemonServer() {
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        ::unlink(socket_path_.c_str());
+    }
+}
+
+void DaemonServer::SetLogger(std::shared_ptr<Logger> logger) {
+    logger_ = std::move(logger);
+}
+
+void DaemonServer::SetRunnerConfig(std::function<void(BTRunner&)> configure) {
+    configure_ = std::move(configure);
+}
+
+void DaemonServer::Listen(const std::string& socket_path) {
+    const sockaddr_un addr = MakeAddress(socket_path);
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        throw std::runtime_error(std::string("socket failed: ") +
+                                 std::strerror(errno));
+    }
+
+    // A previous daemon may have left its socket behind
+    ::unlink(socket_path.c_str());
+    if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&addr),
+               sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, SOMAXCONN) != 0) {
+        const std::string err = std::strerror(errno);
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        throw std::runtime_error("cannot listen on " + socket_path + ": " +
+                                 err);
+    }
+    socket_path_ = socket_path;
+
+    if (logger_) {
+        logger_->info("Daemon: listening on " + socket_path_);
+    }
+}
+
+void DaemonServer::Serve(std::chrono::milliseconds sleep_time) {
+    if (listen_fd_ < 0) {
+        throw std::runtime_error("DaemonServer: Listen() was not called");
+    }
+
+    while (!stop_requested_.load()) {
+        // Wake periodically to notice Stop()
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        const int ready = ::poll(&pfd, 1, 200);
+        if (ready <= 0) continue;
+
+        const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+
+        {
+            std::lock_guard<std::mutex> lock(active_mtx_);
+            ++active_;
+        }
+        std::thread([this, fd, sleep_time] {
+            HandleConnection(fd, sleep_time);
+            ::close(fd);
+            std::lock_guard<std::mutex> lock(active_mtx_);
+            --active_;
+            active_cv_.notify_all();
+        }).detach();
+    }
+
+    // Let running trees finish before the context goes away
+    std::unique_lock<std::mutex> lock(active_mtx_);
+    active_cv_.wait(lock, [this] { return active_ == 0; });
+}
+
+void DaemonServer::HandleConnection(int fd,
+                                    std::chrono::milliseconds sleep_time) {
+    std::string line;
+    if (!ReadLine(fd, line)) return;
+
+    DaemonRequest request;
+    DaemonReply reply;
+    if (!DecodeDaemonRequest(line, request)) {
+        reply.status = "ERROR";
+        reply.error = "malformed request";
+    } else {
+        reply = RunRequest(request, sleep_time);
+    }
+    WriteAll(fd, EncodeDaemonReply(reply));
+}
+
+DaemonReply DaemonServer::RunRequest(const DaemonRequest& request,
+                                     std::chrono::milliseconds sleep_time) {
+    DaemonReply reply;
+    try {
+        BTRunner runner(ctx_, pv_manager_);
+        runner.SetLogger(logger_);
+        runner.SetTreeCache(tree_cache_);
+        if (configure_) configure_(runner);
+        for (const auto& [key, value] : request.globals) {
+            runner.SetGlobalBB(key, value);
+        }
+
+        const auto load_start = std::chrono::steady_clock::now();
+        runner.RegisterTreeFromFile(request.tree_path);
+        reply.load_ms = ElapsedMs(load_start);
+
+        const auto run_start = std::chrono::steady_clock::now();
+        const bool success = runner.Run(sleep_time);
+        reply.run_ms = ElapsedMs(run_start);
+        reply.status = success ? "SUCCESS" : "FAILURE";
+    } catch (const std::exception& e) {
+        reply.status = "ERROR";
+        reply.error = e.what();
+        if (logger_) {
+            logger_->error("Daemon: " + request.tree_path + ": " + e.what());
+        }
+    }
+
+    // The runner is gone; trim channels left idle past the linger policy
+    pv_manager_->CollectGarbage();
+    if (logger_) {
+        const auto stats = pv_manager_->Stats();
+        logger_->debug("Daemon: channels hits=" + std::to_string(stats.hits) +
+                       " linger_hits=" + std::to_string(stats.linger_hits) +
+                       " misses=" + std::to_string(stats.misses) +
+                       " evictions=" + std::to_string(stats.evictions) +
+                       " lingering=" + std::to_string(stats.lingering));
+        const auto dispatch = ctx_->Dispatcher().Stats();
+        logger_->debug(
+            "Daemon: CA dispatch posted=" + std::to_string(dispatch.posted) +
+            " deferred=" + std::to_string(dispatch.deferred) +
+            " rejected=" + std::to_string(dispatch.rejected) +
+            " high_water=" + std::to_string(dispatch.high_water));
+    }
+    return reply;
+}
+
+DaemonReply SubmitToDaemon(const std::string& socket_path,
+                           const DaemonRequest& request) {
+    const sockaddr_un addr = MakeAddress(socket_path);
+    const std::string encoded = EncodeDaemonRequest(request);
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("socket failed: ") +
+                                 std::strerror(errno));
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr),
+                  sizeof(addr)) != 0) {
+        const std::string err = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("cannot connect to " + socket_path + ": " +
+                                 err);
+    }
+
+    std::string line;
+    const bool ok = WriteAll(fd, encoded) && ReadLine(fd, line);
+    ::close(fd);
+
+    DaemonReply reply;
+    if (!ok || !DecodeDaemonReply(line, reply)) {
+        throw std::runtime_error("invalid reply from daemon");
+    }
+    return reply;
+}
+
+}  // namespace bchtree
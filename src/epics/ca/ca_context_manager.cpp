@@ -2,9 +2,17 @@
 
 #include <iostream>
 #include <string>
+#include <utility>
 
 namespace bchtree::epics::ca {
 
+namespace {
+// Batches are tracked per thread so trees ticking concurrently on a shared
+// context never hold back each other's flushes.
+thread_local int t_batch_depth = 0;
+thread_local size_t t_pending_flush = 0;
+}  // namespace
+
 void CAContextManager::Init() {
     std::lock_guard<std::mutex> lock(mtx_);
     if (initialized_) return;
@@ -51,4 +59,45 @@ void CAContextManager::Shutdown() {
     ctx_ = nullptr;
     initialized_ = false;
 }
+
+void CAContextManager::BeginBatch() { ++t_batch_depth; }
+
+void CAContextManager::EndBatch() {
+    if (--t_batch_depth > 0) return;
+
+    if (std::exchange(t_pending_flush, 0) > 0) {
+        Flush();
+    }
+}
+
+void CAContextManager::RequestFlush() {
+    if (t_batch_depth <= 0) {
+        Flush();
+        return;
+    }
+
+    // Flush early if the batch grows large so requests don't pile up
+    if (++t_pending_flush >= flush_threshold_) {
+        t_pending_flush = 0;
+        Flush();
+    }
+}
+
+void CAContextManager::Flush() {
+    flushes_.fetch_add(1, std::memory_order_relaxed);
+    ca_flush_io();
+}
+
+void CAContextManager::SetFlushThreshold(size_t threshold) {
+    flush_threshold_ = threshold;
+}
+
+void CAContextManager::SetMetrics(std::shared_ptr<Metrics> metrics) {
+    metrics_ = std::move(metrics);
+}
+
+void CAContextManager::SetLogger(std::shared_ptr<Logger> logger) {
+    logger_ = std::move(logger);
+}
+
 }  // namespace bchtree::epics::ca
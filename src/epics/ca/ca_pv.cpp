@@ -1,88 +1,324 @@
 #include "epics/ca/ca_pv.h"
 
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+#include "epics/ca/dbr_decode.h"
+
 namespace bchtree::epics::ca {
 
 struct PutCBCtx {
-    CAPV* self;
+    CAPV* self = nullptr;
     PutCallback cb;
+    std::shared_ptr<RequestToken> token;  // null if never revoked
+    LatencyHistogram* rtt = nullptr;
+    std::chrono::steady_clock::time_point issued;
 };
 
-struct PutScalarVisitor {
-    chid cid;
-    PutCBCtx* cb_ctx;
-    caEventCallBackFunc* handler;
+// Hands a put value to put(type, count, data) in its DBR wire layout;
+// the data is valid for the duration of the call
+template <typename Put>
+struct PutValueVisitor {
+    Put& put;
 
-    bool operator()(int32_t v) const {
-        int rc = ca_put_callback(DBR_LONG, cid, &v, handler, cb_ctx);
-        return (rc == ECA_NORMAL);
+    bool operator()(int32_t v) const { return put(DBR_LONG, 1, &v); }
+    bool operator()(float v) const { return put(DBR_FLOAT, 1, &v); }
+    bool operator()(double v) const { return put(DBR_DOUBLE, 1, &v); }
+    bool operator()(uint16_t v) const { return put(DBR_ENUM, 1, &v); }
+    bool operator()(const std::string& s) const {
+        char buf[MAX_STRING_SIZE] = {};
+        std::strncpy(buf, s.c_str(), MAX_STRING_SIZE - 1);
+        return put(DBR_STRING, 1, buf);
     }
-    bool operator()(float v) const {
-        int rc = ca_put_callback(DBR_FLOAT, cid, &v, handler, cb_ctx);
-        return (rc == ECA_NORMAL);
+
+    // Arrays are written straight from the vector storage
+    bool operator()(const std::vector<int32_t>& v) const {
+        return put_array(DBR_LONG, v.size(), v.data());
     }
-    bool operator()(double v) const {
-        int rc = ca_put_callback(DBR_DOUBLE, cid, &v, handler, cb_ctx);
-        return (rc == ECA_NORMAL);
+    bool operator()(const std::vector<float>& v) const {
+        return put_array(DBR_FLOAT, v.size(), v.data());
     }
-    bool operator()(uint16_t v) const {
-        int rc = ca_put_callback(DBR_ENUM, cid, &v, handler, cb_ctx);
-        return (rc == ECA_NORMAL);
+    bool operator()(const std::vector<double>& v) const {
+        return put_array(DBR_DOUBLE, v.size(), v.data());
     }
-    bool operator()(const std::string& s) const {
-        char buf[MAX_STRING_SIZE] = {};
-        std::strncpy(buf, s.c_str(), MAX_STRING_SIZE - 1);
-        int rc = ca_put_callback(DBR_STRING, cid, buf, handler, cb_ctx);
-        return (rc == ECA_NORMAL);
+    bool operator()(const std::vector<uint16_t>& v) const {
+        return put_array(DBR_ENUM, v.size(), v.data());
+    }
+    bool operator()(const std::vector<uint8_t>& v) const {
+        return put_array(DBR_CHAR, v.size(), v.data());
+    }
+    bool operator()(const std::vector<std::string>& v) const {
+        // DBR_STRING arrays are contiguous fixed-size char blocks
+        std::vector<char> buf(v.size() * MAX_STRING_SIZE, '\0');
+        for (size_t i = 0; i < v.size(); ++i) {
+            std::strncpy(&buf[i * MAX_STRING_SIZE], v[i].c_str(),
+                         MAX_STRING_SIZE - 1);
+        }
+        return put_array(DBR_STRING, v.size(), buf.data());
+    }
+
+    bool put_array(chtype type, size_t count, const void* data) const {
+        if (count == 0) return false;
+        return put(type, static_cast<unsigned long>(count), data);
     }
 };
 
-CAPV::CAPV(std::shared_ptr<CAContextManager> ctx, std::string pv_name)
-    : pv_name_(std::move(pv_name)), ctx_(std::move(ctx)) {}
+static_assert(PVData::kMaxString == MAX_STRING_SIZE,
+              "PVData inline strings must hold a DBR_STRING");
+
+MonitorPolicy MonitorPolicy::Parse(const std::string& spec) {
+    MonitorPolicy policy;
+    unsigned long mask = 0;
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t end = spec.find(',', start);
+        if (end == std::string::npos) end = spec.size();
+        const std::string word = spec.substr(start, end - start);
+        start = end + 1;
+
+        if (word.empty()) continue;
+        if (word == "off") {
+            policy.mode = Mode::kOff;
+        } else if (word == "lazy") {
+            policy.mode = Mode::kLazy;
+        } else if (word == "on") {
+            policy.mode = Mode::kOn;
+        } else if (word == "value") {
+            mask |= DBE_VALUE;
+        } else if (word == "log" || word == "archive") {
+            mask |= DBE_LOG;
+        } else if (word.size() > 2 &&
+                   word.compare(word.size() - 2, 2, "ms") == 0 &&
+                   std::all_of(word.begin(), word.end() - 2, [](char c) {
+                       return std::isdigit(static_cast<unsigned char>(c));
+                   })) {
+            // More digits could overflow std::stol
+            if (word.size() - 2 > 9) {
+                throw std::invalid_argument("monitor interval too long [" +
+                                            word + "]");
+            }
+            policy.min_interval = std::chrono::milliseconds(
+                std::stol(word.substr(0, word.size() - 2)));
+        } else {
+            throw std::invalid_argument("unknown monitor policy [" + word +
+                                        "]");
+        }
+    }
+    if (mask) policy.mask = mask | DBE_ALARM;
+    return policy;
+}
+
+std::string MonitorPolicy::ToString() const {
+    std::string spec = mode == Mode::kOff    ? "off"
+                       : mode == Mode::kLazy ? "lazy"
+                                             : "on";
+    if (mask & DBE_VALUE) spec += ",value";
+    if (mask & DBE_LOG) spec += ",log";
+    if (min_interval.count() > 0) {
+        spec += "," + std::to_string(min_interval.count()) + "ms";
+    }
+    return spec;
+}
+
+bool MonitorPolicy::operator==(const MonitorPolicy& other) const {
+    return mode == other.mode && mask == other.mask &&
+           min_interval == other.min_interval;
+}
+
+MonitorPolicy MonitorPolicy::Merge(const MonitorPolicy& other) const {
+    if (other.mode == Mode::kOff) return *this;
+    if (mode == Mode::kOff) return other;
+
+    MonitorPolicy merged;
+    merged.mode = std::max(mode, other.mode);
+    merged.mask = mask | other.mask;
+    merged.min_interval = std::min(min_interval, other.min_interval);
+    return merged;
+}
+
+CAPV::CAPV(std::shared_ptr<CAContextManager> ctx, std::string pv_name,
+           MonitorPolicy policy)
+    : pv_name_(std::move(pv_name)),
+      ctx_(std::move(ctx)),
+      policy_(policy),
+      min_interval_ns_(
+          std::chrono::nanoseconds(policy.min_interval).count()) {}
 
 CAPV::~CAPV() {
     ClearMonitor();
+    if (control_evid_) {
+        ca_clear_subscription(control_evid_);
+        control_evid_ = nullptr;
+    }
+    // A trailing notification may still be queued, even if a later policy
+    // merge has since dropped min_interval to 0
+    ctx_->Coalescer().Cancel(this);
     if (chid_) {
         ca_clear_channel(chid_);
         chid_ = nullptr;
     }
+    // No new events after ca_clear_channel(); drop the queued ones and
+    // the room held for requests that will never complete
+    ctx_->Dispatcher().Unreserve(this, reservations_.exchange(0));
+    ctx_->Dispatcher().Cancel(this);
 }
 
-void CAPV::AddConnCB(ConnCallback cb) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    conn_cbs_.push_back(std::move(cb));
+CallbackId CAPV::AddConnCB(ConnCallback cb) {
+    std::lock_guard<std::mutex> lock(conn_cb_mtx_);
+    const CallbackId id = next_cb_id_++;
+    conn_cbs_.emplace_back(id, std::move(cb));
+    return id;
+}
+
+void CAPV::RemoveConnCB(CallbackId id) {
+    // RunConnCBs invokes callbacks under conn_cb_mtx_, so this waits for it
+    std::lock_guard<std::mutex> lock(conn_cb_mtx_);
+    conn_cbs_.erase(
+        std::remove_if(conn_cbs_.begin(), conn_cbs_.end(),
+                       [id](const auto& entry) { return entry.first == id; }),
+        conn_cbs_.end());
+}
+
+CallbackId CAPV::AddMonitorCB(MonitorCallback cb) {
+    std::lock_guard<std::mutex> lock(monitor_cb_mtx_);
+    const CallbackId id = next_cb_id_++;
+    monitor_cbs_.emplace_back(id, std::move(cb));
+    return id;
+}
+
+void CAPV::RemoveMonitorCB(CallbackId id) {
+    std::lock_guard<std::mutex> lock(monitor_cb_mtx_);
+    monitor_cbs_.erase(
+        std::remove_if(monitor_cbs_.begin(), monitor_cbs_.end(),
+                       [id](const auto& entry) { return entry.first == id; }),
+        monitor_cbs_.end());
 }
 
 void CAPV::Connect() {
     std::lock_guard<std::mutex> lock(mtx_);
     if (chid_) return;
 
+    connect_started_ = std::chrono::steady_clock::now();
+    connect_pending_ = true;
     int st = ca_create_channel(pv_name_.c_str(), &ConnHandler, this,
                                CA_PRIORITY_DEFAULT, &chid_);
     if (st != ECA_NORMAL) throw std::runtime_error("ca_create_channel failed");
 }
 
-bool CAPV::PutCB(const PVScalarValue& v, PutCallback cb) {
-    auto cb_ctx = std::make_unique<PutCBCtx>();
+void CAPV::ApplyMonitorPolicy(const MonitorPolicy& policy) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!policy_set_) {
+        // The first explicit policy replaces the default
+        policy_set_ = true;
+        policy_ = policy;
+    } else {
+        const MonitorPolicy merged = policy_.Merge(policy);
+        if (!(merged == policy) || !(merged == policy_)) {
+            Report("monitor policies [" + policy_.ToString() + "] and [" +
+                   policy.ToString() +
+                   "] of users sharing the channel merged into [" +
+                   merged.ToString() + "]");
+        }
+        policy_ = merged;
+    }
+    min_interval_ns_ =
+        std::chrono::nanoseconds(policy_.min_interval).count();
+
+    if (evid_ && (policy_.mode == MonitorPolicy::Mode::kOff ||
+                  (policy_.mode == MonitorPolicy::Mode::kLazy &&
+                   !monitor_requested_) ||
+                  policy_.mask != monitor_mask_)) {
+        // A new subscription delivers the current value
+        ClearMonitor();
+    }
+    EnsureStartMonitor();
+}
+
+MonitorPolicy CAPV::GetMonitorPolicy() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return policy_;
+}
+
+bool CAPV::RequestMonitor() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (policy_.mode == MonitorPolicy::Mode::kOff) return false;
+    if (!monitor_requested_) {
+        monitor_requested_ = true;
+        EnsureStartMonitor();
+    }
+    return true;
+}
+
+bool CAPV::PutCB(const PVScalarValue& v, PutCallback cb,
+                 std::shared_ptr<RequestToken> token) {
+    auto put = [&](chtype type, unsigned long count, const void* data) {
+        return IssuePut(type, count, data, std::move(cb), std::move(token));
+    };
+    return std::visit(PutValueVisitor<decltype(put)>{put}, v);
+}
+
+bool CAPV::PutCB(const PVArrayValue& v, PutCallback cb,
+                 std::shared_ptr<RequestToken> token) {
+    auto put = [&](chtype type, unsigned long count, const void* data) {
+        return IssuePut(type, count, data, std::move(cb), std::move(token));
+    };
+    return std::visit(PutValueVisitor<decltype(put)>{put}, v);
+}
+
+bool CAPV::IssuePut(chtype type, unsigned long count, const void* data,
+                    PutCallback cb, std::shared_ptr<RequestToken> token) {
+    if (!ReserveCompletion()) return false;
+    auto cb_ctx = AcquireRequest<PutCBCtx>();
     cb_ctx->self = this;
     cb_ctx->cb = std::move(cb);
+    cb_ctx->token = std::move(token);
+    cb_ctx->rtt = MetricHistogram(put_rtt_hist_, "ca_put_rtt");
+    if (cb_ctx->rtt) cb_ctx->issued = std::chrono::steady_clock::now();
 
     // Pass cb_ctx pointer to user
     PutCBCtx* raw = cb_ctx.release();
 
-    PutScalarVisitor visitor{chid_, raw, &PutHandler};
-    bool success = std::visit(visitor, v);
-
-    ca_flush_io();
-
-    if (!success) {
+    int st = ca_array_put_callback(type, count, chid_, data, &PutHandler, raw);
+    if (st != ECA_NORMAL) {
         // Reclaim ownership
-        std::unique_ptr<PutCBCtx> reclaim(raw);
+        PooledRequest<PutCBCtx> reclaim(raw);
+        ReleaseCompletion();
         return false;
     }
+    ctx_->RequestFlush();
 
     return true;
 }
 
+void CAPV::Report(const std::string& msg) const {
+    if (Logger* logger = ctx_->GetLogger()) {
+        logger->warn(pv_name_ + ": " + msg);
+    } else {
+        std::cout << pv_name_ + ": " + msg + "\n";
+    }
+}
+
+bool CAPV::ReserveCompletion() {
+    if (!ctx_->Dispatcher().Reserve(this)) {
+        Report("CA dispatch queue full");
+        return false;
+    }
+    ++reservations_;
+    return true;
+}
+
+void CAPV::ReleaseCompletion() {
+    --reservations_;
+    ctx_->Dispatcher().Unreserve(this);
+}
+
+void CAPV::PostCompletion(CallbackDispatcher::TaskFn fn, void* arg,
+                          uintptr_t data) {
+    --reservations_;
+    ctx_->Dispatcher().PostReserved(this, fn, arg, data);
+}
+
 std::string CAPV::GetPVname() const { return pv_name_; };
 
 bool CAPV::IsConnected() const {
@@ -90,34 +326,110 @@ bool CAPV::IsConnected() const {
     return connected_;
 }
 
+bool CAPV::HasValue() const { return has_value_; }
+
+LatencyHistogram* CAPV::MetricHistogram(std::atomic<LatencyHistogram*>& slot,
+                                        const char* family) {
+    Metrics* metrics = ctx_->GetMetrics();
+    if (!metrics) return nullptr;
+
+    LatencyHistogram* hist = slot.load(std::memory_order_acquire);
+    if (!hist) {
+        // Metrics::Get is idempotent, so a racing lookup is harmless
+        hist = metrics->Get(family, pv_name_);
+        slot.store(hist, std::memory_order_release);
+    }
+    return hist;
+}
+
 void CAPV::ConnHandler(struct connection_handler_args args) {
     auto* self = static_cast<CAPV*>(ca_puser(args.chid));
     if (!self) return;
 
-    std::lock_guard<std::mutex> lock(self->mtx_);
-    self->connected_ = (args.op == CA_OP_CONN_UP);
+    const bool connected = (args.op == CA_OP_CONN_UP);
+    {
+        std::lock_guard<std::mutex> lock(self->mtx_);
+        self->connected_ = connected;
+        ++self->conn_changes_;
+
+        if (connected) {
+            self->native_type_ = ca_field_type(self->chid_);
+            self->elem_count_ = ca_element_count(self->chid_);
+            if (self->connect_pending_) {
+                self->connect_pending_ = false;
+                if (auto* hist = self->MetricHistogram(self->connect_hist_,
+                                                       "ca_connect")) {
+                    hist->Record(std::chrono::steady_clock::now() -
+                                 self->connect_started_);
+                }
+            }
+        } else {
+            // CA resends the current value on reconnect; wait for it
+            self->has_value_ = false;
+        }
 
-    if (self->connected_) {
-        self->native_type_ = ca_field_type(self->chid_);
-        self->elem_count_ = ca_element_count(self->chid_);
+        // Subscribes unless the policy is off or lazy and not yet requested
+        self->EnsureStartMonitor();
+        self->EnsureControlSubscription();
     }
 
-    std::vector<ConnCallback> cbs;
-    cbs = self->conn_cbs_;
-    for (auto& cb : cbs) {
-        if (cb) cb(self->connected_);
+    // One queued event per channel; it delivers the latest state
+    if (!self->conn_queued_.exchange(true)) {
+        self->ctx_->Dispatcher().Post(self, &CAPV::RunConnCBs, self);
     }
+}
 
-    // Alway start monitor for now
-    self->EnsureStartMonitor();
+void CAPV::RunConnCBs(void* arg, uintptr_t, bool run) {
+    auto* self = static_cast<CAPV*>(arg);
+    // Cleared first: a later change queues a new event
+    self->conn_queued_ = false;
+    if (!run) return;
+
+    bool connected;
+    uint64_t changes;
+    {
+        std::lock_guard<std::mutex> lock(self->mtx_);
+        connected = self->connected_;
+        changes = self->conn_changes_;
+    }
+    // Not under mtx_, so a slow callback never holds up ConnHandler
+    std::lock_guard<std::mutex> lock(self->conn_cb_mtx_);
+    if (changes == self->conn_delivered_) return;
+    self->conn_delivered_ = changes;
+
+    // Changes alternate, so an unchanged state means merged events hid a
+    // bounce; report it as a drop and a recovery
+    if (connected == self->conn_reported_) {
+        for (auto& [id, cb] : self->conn_cbs_) {
+            if (cb) cb(!connected);
+        }
+    }
+    self->conn_reported_ = connected;
+    for (auto& [id, cb] : self->conn_cbs_) {
+        if (cb) cb(connected);
+    }
 }
 
 void CAPV::PutHandler(struct event_handler_args args) {
-    std::unique_ptr<PutCBCtx> cb_ctx(static_cast<PutCBCtx*>(args.usr));
+    PooledRequest<PutCBCtx> cb_ctx(static_cast<PutCBCtx*>(args.usr));
     if (!cb_ctx || !cb_ctx->self) return;
+    if (cb_ctx->rtt) {
+        cb_ctx->rtt->Record(std::chrono::steady_clock::now() - cb_ctx->issued);
+    }
+
+    CAPV* self = cb_ctx->self;
+    self->PostCompletion(&CAPV::RunPutCB, cb_ctx.release(),
+                         args.status == ECA_NORMAL);
+}
 
-    bool success{args.status == ECA_NORMAL};
-    cb_ctx->cb(success);
+void CAPV::RunPutCB(void* arg, uintptr_t success, bool run) {
+    PooledRequest<PutCBCtx> cb_ctx(static_cast<PutCBCtx*>(arg));
+    if (!run) return;
+    // Release the slot before user code runs, as RunGetCB does
+    PutCallback cb = std::move(cb_ctx->cb);
+    std::shared_ptr<RequestToken> token = std::move(cb_ctx->token);
+    cb_ctx.reset();
+    RequestToken::Invoke(token.get(), [&] { cb(success != 0); });
 }
 
 void CAPV::MonitorHandler(struct event_handler_args args) {
@@ -128,25 +440,154 @@ void CAPV::MonitorHandler(struct event_handler_args args) {
         return;
     }
 
-    std::lock_guard<std::mutex> lock(self->mtx_);
-    self->pvdata_ = DecodePVScalar(args.type, args.dbr);
+    // Decode outside the lock, then publish the new snapshot atomically.
+    // An undecodable update keeps the previous value.
+    std::shared_ptr<const PVData> snap;
+    try {
+        snap = std::make_shared<const PVData>(
+            DecodePVData(args.type, args.count, args.dbr));
+    } catch (const std::exception& e) {
+        if (!self->decode_error_reported_.exchange(true)) {
+            self->Report(e.what());
+        }
+        return;
+    }
+    std::atomic_store(&self->snapshot_, std::move(snap));
+    self->has_value_ = true;
+    ++self->value_updates_;
+
+    // Invoke outside mtx_ so callbacks may read the value
+    const std::chrono::nanoseconds interval(self->min_interval_ns_.load());
+    if (interval.count() == 0) {
+        self->NotifyMonitor();
+        return;
+    }
+    std::chrono::steady_clock::time_point due;
+    {
+        std::lock_guard<std::mutex> lock(self->rate_mtx_);
+        const auto now = std::chrono::steady_clock::now();
+        if (now - self->last_notify_ >= interval) {
+            self->last_notify_ = now;
+            self->notify_pending_ = false;
+        } else if (self->notify_pending_) {
+            return;  // already coalescing
+        } else {
+            self->notify_pending_ = true;
+            due = self->last_notify_ + interval;
+        }
+    }
+    if (due == std::chrono::steady_clock::time_point{}) {
+        self->NotifyMonitor();
+        return;
+    }
+    // Outside rate_mtx_: the coalescer takes it when flushing
+    self->ctx_->Coalescer().Schedule(self, due);
+}
+
+void CAPV::ControlHandler(struct event_handler_args args) {
+    auto* self = static_cast<CAPV*>(args.usr);
+    if (!self || args.status != ECA_NORMAL) return;
+
+    std::shared_ptr<const PVControlInfo> info;
+    try {
+        info = std::make_shared<const PVControlInfo>(
+            DecodeControlInfo(args.type, args.dbr));
+    } catch (const std::exception& e) {
+        self->Report(e.what());
+        return;
+    }
+    std::atomic_store(&self->control_info_, std::move(info));
+
+    // Wakes readers waiting for the properties
+    self->NotifyMonitor();
+}
+
+void CAPV::FlushCoalesced() {
+    {
+        std::lock_guard<std::mutex> lock(rate_mtx_);
+        if (!notify_pending_) return;
+        notify_pending_ = false;
+        last_notify_ = std::chrono::steady_clock::now();
+    }
+    NotifyMonitor();
+}
+
+void CAPV::NotifyMonitor() {
+    if (notify_queued_.exchange(true)) return;
+    ctx_->Dispatcher().Post(this, &CAPV::RunMonitorCBs, this);
+}
+
+void CAPV::RunMonitorCBs(void* arg, uintptr_t, bool run) {
+    auto* self = static_cast<CAPV*>(arg);
+    // Cleared first: a later update queues a new notification
+    self->notify_queued_ = false;
+    if (!run) return;
+    std::lock_guard<std::mutex> lock(self->monitor_cb_mtx_);
+    self->NotifyMonitorCBs();
+}
+
+void CAPV::NotifyMonitorCBs() {
+    for (auto& [id, cb] : monitor_cbs_) {
+        if (cb) cb();
+    }
 }
 
 void CAPV::EnsureStartMonitor() {
     if (!connected_ or !chid_) return;  // Not connected
     if (evid_) return;                  // Alread started
+    if (policy_.mode == MonitorPolicy::Mode::kOff) return;
+    if (policy_.mode == MonitorPolicy::Mode::kLazy && !monitor_requested_) {
+        return;  // Nobody reads monitor data yet
+    }
 
-    const short dbf = ca_field_type(chid_);
     const chtype dbr_type = PreferredGetType(native_type_);
+    const unsigned long cnt = RequestCount();
 
-    // Only scalar value is supported now
-    const unsigned long cnt = 1;
-
-    int st = ca_create_subscription(dbr_type, cnt, chid_, DBE_VALUE | DBE_ALARM,
+    int st = ca_create_subscription(dbr_type, cnt, chid_, policy_.mask,
                                     &CAPV::MonitorHandler, this, &evid_);
     if (st != ECA_NORMAL) {
-        std::cout << "status=" << st << " : " << ca_message(st) << "\n";
+        Report(std::string("monitor not started: ") + ca_message(st));
+        return;
+    }
+    monitor_mask_ = policy_.mask;
+}
+
+void CAPV::EnsureControlSubscription() {
+    if (!connected_ or !chid_) return;  // Not connected
+    if (control_evid_) return;          // CA resubscribes on reconnection
+
+    if (native_type_ == DBF_STRING) {
+        // No properties beyond the value
+        std::atomic_store(&control_info_,
+                          std::make_shared<const PVControlInfo>());
+        return;
+    }
+    // One element is enough: only the properties are used. This is the
+    // single CTRL request per channel; gets and monitors use DBR_TIME_*.
+    const chtype dbr_type =
+        static_cast<chtype>(dbf_type_to_DBR_CTRL(native_type_));
+    int st = ca_create_subscription(dbr_type, 1, chid_, DBE_PROPERTY,
+                                    &CAPV::ControlHandler, this,
+                                    &control_evid_);
+    if (st != ECA_NORMAL) {
+        Report(std::string("property monitor not started: ") +
+               ca_message(st));
+    }
+}
+
+std::string CAPV::EnumLabel(uint16_t index) const {
+    const auto info = ControlInfo();
+    if (info) {
+        const std::string_view label = info->EnumString(index);
+        if (!label.empty()) return std::string(label);
     }
+    return std::to_string(index);
+}
+
+unsigned long CAPV::RequestCount() const {
+    // Whole waveform for arrays, a single element for scalars. Large
+    // waveforms need EPICS_CA_MAX_ARRAY_BYTES raised on client and IOC.
+    return static_cast<unsigned long>(std::max<size_t>(elem_count_, 1));
 }
 
 void CAPV::ClearMonitor() {
@@ -156,44 +597,22 @@ void CAPV::ClearMonitor() {
     evid_ = nullptr;
 }
 
+PVData CAPV::DecodePVData(chtype type, long count, const void* dbr) {
+    return DecodeDbr(type, count, dbr, count > 1);
+}
+
+PVData CAPV::DecodePVArray(chtype type, long count, const void* dbr) {
+    return DecodeDbr(type, count, dbr, true);
+}
+
 PVData CAPV::DecodePVScalar(chtype type, const void* dbr) {
-    PVData data{};
-    switch (type) {
-        case DBR_TIME_STRING: {
-            auto v = static_cast<const dbr_time_string*>(dbr);
-            data.value = bchtree::epics::PVScalarValue{v->value};
-            break;
-        }
-        case DBR_TIME_DOUBLE: {
-            auto v = static_cast<const dbr_time_double*>(dbr);
-            data.value = bchtree::epics::PVScalarValue{v->value};
-            break;
-        }
-        case DBR_TIME_FLOAT: {
-            auto v = static_cast<const dbr_time_float*>(dbr);
-            data.value = bchtree::epics::PVScalarValue{v->value};
-            break;
-        }
-        case DBR_TIME_LONG: {
-            auto v = static_cast<const dbr_time_long*>(dbr);
-            data.value = bchtree::epics::PVScalarValue{v->value};
-            break;
-        }
-        case DBR_TIME_INT: {
-            auto v = static_cast<const dbr_time_short*>(dbr);
-            data.value = bchtree::epics::PVScalarValue{v->value};
-            break;
-        }
-        case DBR_TIME_ENUM: {
-            auto v = static_cast<const dbr_time_enum*>(dbr);
-            data.value = bchtree::epics::PVScalarValue{v->value};
-            break;
-        }
-        default: {
-            throw std::runtime_error("unsupported DBR type");
-        }
-    }
-    return data;
+    return DecodeDbr(type, 1, dbr, false);
+}
+
+const std::shared_ptr<const PVData>& CAPV::EmptySnapshot() {
+    static const std::shared_ptr<const PVData> empty =
+        std::make_shared<const PVData>();
+    return empty;
 }
 
 chtype CAPV::PreferredGetType(chtype dbf) {
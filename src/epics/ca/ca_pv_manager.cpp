@@ -1,57 +1,268 @@
 #include "epics/ca/ca_pv_manager.h"
 
+#include <algorithm>
+#include <mutex>
+
 namespace bchtree::epics::ca {
 
-std::shared_ptr<CAPV> PVManager::Get(const std::string& pv_name) {
-    std::shared_ptr<CAPV> pv;
+size_t PVManager::Hash(std::string_view pv_name) {
+    return std::hash<std::string_view>{}(pv_name);
+}
+
+std::shared_ptr<CAPV> PVManager::Get(std::string_view pv_name) {
+    return Get(pv_name, Hash(pv_name));
+}
 
-    std::lock_guard<std::mutex> lock(mtx_);
-    auto it = registry_.find(pv_name);
-    if (it != registry_.end()) {
-        pv = it->second.lock();
-        if (!pv) {
-            // expired -> erase entry so we can recreate
-            registry_.erase(it);
+std::shared_ptr<CAPV> PVManager::Get(std::string_view pv_name, size_t hash) {
+    Shard& shard = ShardFor(hash);
+
+    // Fast path: shared lock, hit on a channel that is in use
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mtx);
+        auto [first, last] = shard.registry.equal_range(hash);
+        for (auto it = first; it != last; ++it) {
+            if (it->second.name == pv_name) {
+                if (auto pv = it->second.channel->lease.lock()) {
+                    ++hits_;
+                    return pv;
+                }
+                break;
+            }
         }
     }
-    if (!pv) {
-        pv = std::make_shared<CAPV>(ctx_, pv_name);
-        registry_.emplace(pv_name, pv);
+
+    // Slow path: re-check under the exclusive lock before creating
+    std::unique_lock<std::shared_mutex> lock(shard.mtx);
+    auto [first, last] = shard.registry.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (it->second.name != pv_name) continue;
+        const auto channel = it->second.channel;
+        if (auto pv = channel->lease.lock()) {
+            ++hits_;
+            return pv;
+        }
+        if (auto pv = Lease(channel)) {
+            // Idle but still connected
+            ++linger_hits_;
+            return pv;
+        }
+        // closed -> erase entry so we can recreate
+        shard.registry.erase(it);
+        break;
     }
 
-    return pv;
+    MonitorPolicy monitor;
+    {
+        std::lock_guard<std::mutex> policy_lock(policy_mtx_);
+        monitor = default_monitor_;
+    }
+    auto channel = std::make_shared<Channel>();
+    channel->pv = std::make_shared<CAPV>(ctx_, std::string(pv_name), monitor);
+    shard.registry.emplace(hash, Entry{std::string(pv_name), channel});
+    ++misses_;
+    return Lease(channel);
 }
 
-void PVManager::Remove(const std::string& pv_name) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    registry_.erase(pv_name);
+std::shared_ptr<CAPV> PVManager::Lease(
+    const std::shared_ptr<Channel>& channel) {
+    std::lock_guard<std::mutex> lock(channel->mtx);
+    if (!channel->pv) return nullptr;
+
+    const uint64_t generation = ++channel->generation;
+    channel->linger = linger_enabled_;
+
+    // The deleter never deletes: the channel owns the CAPV
+    std::shared_ptr<CAPV> lease(
+        channel->pv.get(), [channel, generation](CAPV*) {
+            std::shared_ptr<CAPV> closing;
+            {
+                std::lock_guard<std::mutex> lock(channel->mtx);
+                if (generation != channel->generation) return;
+                if (channel->linger) {
+                    channel->released = std::chrono::steady_clock::now();
+                } else {
+                    closing = std::move(channel->pv);
+                }
+            }
+            // ca_clear_channel runs here, outside the channel lock
+        });
+    channel->lease = lease;
+    return lease;
+}
+
+std::vector<std::shared_ptr<CAPV>> PVManager::Prewarm(
+    const std::vector<std::string>& pv_names) {
+    ctx_->EnsureAttached();
+
+    std::vector<std::shared_ptr<CAPV>> pvs;
+    pvs.reserve(pv_names.size());
+
+    // Search requests for every channel go out together when the batch ends
+    IOBatch batch(*ctx_);
+    for (const auto& name : pv_names) {
+        auto pv = Get(name);
+        pv->Connect();
+        pvs.push_back(std::move(pv));
+    }
+    ctx_->RequestFlush();
+
+    return pvs;
+}
+
+void PVManager::Remove(std::string_view pv_name) {
+    const size_t hash = Hash(pv_name);
+    Shard& shard = ShardFor(hash);
+
+    std::unique_lock<std::shared_mutex> lock(shard.mtx);
+    auto [first, last] = shard.registry.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (it->second.name == pv_name) {
+            shard.registry.erase(it);
+            return;
+        }
+    }
 }
 
 void PVManager::Shutdown() {
-    // Keep it simple: just clear the registry.
-    // CAPV instances will be destroyed when all external shared_ptrs are
-    // released.
-    std::lock_guard<std::mutex> lock(mtx_);
-    registry_.clear();
+    // Keep it simple: just clear the registry. Lingering channels close
+    // here; CAPV instances in use are destroyed when all external
+    // shared_ptrs are released.
+    for (auto& shard : shards_) {
+        std::unique_lock<std::shared_mutex> lock(shard.mtx);
+        shard.registry.clear();
+    }
 }
 
 size_t PVManager::RegistrySize() const {
-    std::lock_guard<std::mutex> lock(mtx_);
-    return registry_.size();
+    size_t size = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard.mtx);
+        size += shard.registry.size();
+    }
+    return size;
 }
 
 size_t PVManager::CollectGarbage() {
-    std::lock_guard<std::mutex> lock(mtx_);
     size_t erased = 0;
-    for (auto it = registry_.begin(); it != registry_.end();) {
-        if (it->second.expired()) {
-            it = registry_.erase(it);
-            ++erased;
-        } else {
-            ++it;
+    for (auto& shard : shards_) {
+        std::unique_lock<std::shared_mutex> lock(shard.mtx);
+        for (auto it = shard.registry.begin(); it != shard.registry.end();) {
+            const auto& channel = it->second.channel;
+            bool closed;
+            {
+                std::lock_guard<std::mutex> channel_lock(channel->mtx);
+                closed = !channel->pv;
+            }
+            if (closed) {
+                it = shard.registry.erase(it);
+                ++erased;
+            } else {
+                ++it;
+            }
+        }
+    }
+    return erased + EvictIdle();
+}
+
+size_t PVManager::CollectGarbageIfDue() {
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch())
+                            .count();
+    int64_t due = next_collect_ns_.load(std::memory_order_relaxed);
+    if (now < due) return 0;
+
+    // Not every tick, even with a tiny max_idle: it takes every shard lock
+    const auto interval = std::clamp(GetLingerPolicy().max_idle,
+                                     std::chrono::milliseconds(10),
+                                     kCollectInterval);
+    const int64_t next = now + std::chrono::nanoseconds(interval).count();
+    // One caller per interval does the work
+    if (!next_collect_ns_.compare_exchange_strong(due, next)) return 0;
+    return CollectGarbage();
+}
+
+size_t PVManager::EvictIdle() {
+    const LingerPolicy policy = GetLingerPolicy();
+    const auto now = std::chrono::steady_clock::now();
+
+    // Shards are always locked in index order, and Get() holds only one
+    std::array<std::unique_lock<std::shared_mutex>, kShardCount> locks;
+    for (size_t i = 0; i < kShardCount; ++i) {
+        locks[i] = std::unique_lock<std::shared_mutex>(shards_[i].mtx);
+    }
+
+    struct Idle {
+        std::chrono::steady_clock::time_point released;
+        Shard* shard;
+        decltype(Shard::registry)::iterator it;
+    };
+    std::vector<Idle> idle;
+    for (auto& shard : shards_) {
+        for (auto it = shard.registry.begin(); it != shard.registry.end();
+             ++it) {
+            auto& channel = *it->second.channel;
+            if (!channel.lease.expired()) continue;
+            std::lock_guard<std::mutex> lock(channel.mtx);
+            if (channel.pv) idle.push_back({channel.released, &shard, it});
+        }
+    }
+
+    // Oldest first; everything past max_idle or over max_channels goes
+    std::sort(idle.begin(), idle.end(), [](const Idle& a, const Idle& b) {
+        return a.released < b.released;
+    });
+    std::vector<std::shared_ptr<CAPV>> closing;
+    for (size_t i = 0; i < idle.size(); ++i) {
+        const bool expired = now - idle[i].released > policy.max_idle;
+        const bool over = idle.size() - i > policy.max_channels;
+        if (!expired && !over) break;
+
+        auto& channel = *idle[i].it->second.channel;
+        {
+            std::lock_guard<std::mutex> lock(channel.mtx);
+            closing.push_back(std::move(channel.pv));
+        }
+        idle[i].shard->registry.erase(idle[i].it);
+    }
+    evictions_ += closing.size();
+
+    for (auto& lock : locks) lock.unlock();
+    // Channels are cleared here, after every shard is released
+    return closing.size();
+}
+
+void PVManager::SetLingerPolicy(const LingerPolicy& policy) {
+    std::lock_guard<std::mutex> lock(policy_mtx_);
+    policy_ = policy;
+    linger_enabled_ = policy.max_channels > 0;
+}
+
+void PVManager::SetDefaultMonitorPolicy(const MonitorPolicy& policy) {
+    std::lock_guard<std::mutex> lock(policy_mtx_);
+    default_monitor_ = policy;
+}
+
+LingerPolicy PVManager::GetLingerPolicy() const {
+    std::lock_guard<std::mutex> lock(policy_mtx_);
+    return policy_;
+}
+
+PVManagerStats PVManager::Stats() const {
+    PVManagerStats stats;
+    stats.hits = hits_;
+    stats.linger_hits = linger_hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard.mtx);
+        for (const auto& [hash, entry] : shard.registry) {
+            auto& channel = *entry.channel;
+            if (!channel.lease.expired()) continue;
+            std::lock_guard<std::mutex> channel_lock(channel.mtx);
+            if (channel.pv) ++stats.lingering;
         }
     }
-    return erased;
+    return stats;
 }
 
 }  // namespace bchtree::epics::ca
@@ -0,0 +1,367 @@
+#include "epics/ca/callback_dispatcher.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+#include "epics/ca/ca_context_manager.h"
+
+namespace bchtree::epics::ca {
+
+namespace {
+// Owner of the event being delivered on this thread, so that Cancel()
+// called from inside one of its events does not wait for itself
+thread_local const void* t_delivering = nullptr;
+}  // namespace
+
+DispatchPolicy DispatchPolicy::Parse(const std::string& spec) {
+    DispatchPolicy policy;
+    if (spec == "inline") return policy;
+    if (spec == "tick") {
+        policy.mode = Mode::kTick;
+        return policy;
+    }
+    if (!spec.empty() && spec.size() <= 4 &&
+        std::all_of(spec.begin(), spec.end(), [](char c) {
+            return std::isdigit(static_cast<unsigned char>(c));
+        })) {
+        const int workers = std::stoi(spec);
+        if (workers > 0) {
+            policy.mode = Mode::kWorkers;
+            policy.workers = static_cast<size_t>(workers);
+            return policy;
+        }
+    }
+    throw std::invalid_argument("unknown callback dispatch [" + spec + "]");
+}
+
+CallbackDispatcher::~CallbackDispatcher() { StopShards(shards_); }
+
+void CallbackDispatcher::SetPolicy(const DispatchPolicy& policy) {
+    std::vector<std::unique_ptr<Shard>> old;
+    {
+        std::unique_lock<std::shared_mutex> lock(policy_mtx_);
+        policy_ = policy;
+        policy_.workers = std::max<size_t>(policy.workers, 1);
+        policy_.capacity = std::max<size_t>(policy.capacity, 1);
+        old.swap(shards_);
+
+        size_t count = 0;
+        if (policy_.mode == DispatchPolicy::Mode::kWorkers) {
+            count = policy_.workers;
+        } else if (policy_.mode == DispatchPolicy::Mode::kTick) {
+            count = 1;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            auto shard = std::make_unique<Shard>();
+            shard->ring.resize(policy_.capacity);
+            if (policy_.mode == DispatchPolicy::Mode::kWorkers) {
+                Shard* raw = shard.get();
+                shard->worker = std::thread([this, raw] { RunWorker(*raw); });
+            }
+            shards_.push_back(std::move(shard));
+        }
+    }
+
+    // Events queued under the previous policy are still delivered
+    StopShards(old);
+    std::unique_lock<std::shared_mutex> lock(policy_mtx_);
+    for (auto& shard : old) retired_.push_back(std::move(shard));
+}
+
+DispatchPolicy CallbackDispatcher::GetPolicy() const {
+    std::shared_lock<std::shared_mutex> lock(policy_mtx_);
+    return policy_;
+}
+
+void CallbackDispatcher::Post(const void* owner, TaskFn fn, void* arg,
+                              uintptr_t data) {
+    Queue(Task{owner, fn, arg, data, {}, true}, false);
+}
+
+void CallbackDispatcher::PostReserved(const void* owner, TaskFn fn, void* arg,
+                                      uintptr_t data) {
+    Queue(Task{owner, fn, arg, data, {}, false}, true);
+}
+
+bool CallbackDispatcher::Reserve(const void* owner) {
+    std::shared_lock<std::shared_mutex> guard(policy_mtx_);
+    if (shards_.empty()) return true;
+
+    Shard& shard = ShardFor(owner);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    if (shard.stop) return true;  // the completion will run inline
+    if (shard.size + shard.reserved >= shard.ring.size()) {
+        ++rejected_;
+        return false;
+    }
+    ++shard.reserved;
+    return true;
+}
+
+void CallbackDispatcher::Unreserve(const void* owner, size_t count) {
+    if (count == 0) return;
+    std::shared_lock<std::shared_mutex> guard(policy_mtx_);
+    if (shards_.empty()) return;
+
+    Shard& shard = ShardFor(owner);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    shard.reserved -= std::min(count, shard.reserved);
+    Refill(shard);
+}
+
+void CallbackDispatcher::Queue(Task task, bool reserved) {
+    {
+        std::shared_lock<std::shared_mutex> guard(policy_mtx_);
+        if (!shards_.empty()) {
+            if (WaitHistogram()) task.queued = std::chrono::steady_clock::now();
+            Shard& shard = ShardFor(task.owner);
+            std::unique_lock<std::mutex> lock(shard.mtx);
+            if (Enqueue(shard, task, reserved)) {
+                const size_t depth = shard.size;
+                lock.unlock();
+                // Several tick threads may be waiting
+                shard.ready.notify_all();
+
+                ++posted_;
+                size_t high = high_water_.load(std::memory_order_relaxed);
+                while (depth > high &&
+                       !high_water_.compare_exchange_weak(high, depth)) {
+                }
+                return;
+            }
+        }
+    }
+    // Inline dispatch, or the dispatcher is shutting down
+    task.fn(task.arg, task.data, true);
+}
+
+bool CallbackDispatcher::Enqueue(Shard& shard, const Task& task,
+                                 bool reserved) {
+    if (shard.stop) return false;
+
+    bool fits = false;
+    if (reserved && shard.reserved > 0) {
+        // The room was held since the request was issued
+        --shard.reserved;
+        fits = true;
+    } else if (shard.deferred.empty()) {
+        // A completion without a reservation (issued under a previous
+        // policy) may use any free room, a state event only its half
+        fits = shard.size + shard.reserved < shard.ring.size() &&
+               (!task.state || shard.states < StateRoom(shard));
+    }
+    if (!fits) {
+        ++deferred_;
+        shard.deferred.push_back(task);
+        return true;
+    }
+
+    shard.ring[(shard.head + shard.size) % shard.ring.size()] = task;
+    ++shard.size;
+    if (task.state) ++shard.states;
+    return true;
+}
+
+void CallbackDispatcher::Refill(Shard& shard) {
+    while (!shard.deferred.empty()) {
+        const Task& task = shard.deferred.front();
+        if (shard.size + shard.reserved >= shard.ring.size() ||
+            (task.state && shard.states >= StateRoom(shard))) {
+            return;
+        }
+        shard.ring[(shard.head + shard.size) % shard.ring.size()] = task;
+        ++shard.size;
+        if (task.state) ++shard.states;
+        shard.deferred.pop_front();
+    }
+}
+
+void CallbackDispatcher::Cancel(const void* owner) {
+    std::vector<Task> dropped;
+    {
+        std::shared_lock<std::shared_mutex> guard(policy_mtx_);
+        if (shards_.empty()) return;
+
+        Shard& shard = ShardFor(owner);
+        std::unique_lock<std::mutex> lock(shard.mtx);
+        // Compact the ring, keeping other owners' events in order
+        const size_t capacity = shard.ring.size();
+        size_t kept = 0;
+        for (size_t i = 0; i < shard.size; ++i) {
+            const Task& task = shard.ring[(shard.head + i) % capacity];
+            if (task.owner == owner) {
+                dropped.push_back(task);
+                if (task.state) --shard.states;
+            } else {
+                shard.ring[(shard.head + kept++) % capacity] = task;
+            }
+        }
+        shard.size = kept;
+        for (auto it = shard.deferred.begin(); it != shard.deferred.end();) {
+            if (it->owner == owner) {
+                dropped.push_back(*it);
+                it = shard.deferred.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        Refill(shard);
+
+        if (t_delivering != owner) {
+            shard.finished.wait(lock,
+                                [&] { return shard.running != owner; });
+        }
+    }
+
+    cancelled_ += dropped.size();
+    for (const Task& task : dropped) task.fn(task.arg, task.data, false);
+}
+
+size_t CallbackDispatcher::Drain(size_t max) {
+    Shard* shard = TickShard();
+    if (!shard) return 0;
+
+    std::unique_lock<std::mutex> drain(shard->drain_mtx, std::try_to_lock);
+    if (!drain) return 0;
+
+    std::unique_lock<std::mutex> lock(shard->mtx);
+    shard->draining = true;
+    size_t delivered = 0;
+    while (delivered < max && Pending(*shard)) {
+        DeliverOne(*shard, lock);
+        ++delivered;
+    }
+    shard->draining = false;
+    const bool left = Pending(*shard);
+    lock.unlock();
+    // Another tick thread may be waiting for what is left
+    if (left) shard->ready.notify_all();
+    return delivered;
+}
+
+bool CallbackDispatcher::WaitForEvents(std::chrono::milliseconds timeout) {
+    Shard* shard = TickShard();
+    if (!shard) return false;
+
+    // Events another thread is draining would only make the caller spin
+    std::unique_lock<std::mutex> lock(shard->mtx);
+    auto drainable = [&] { return Pending(*shard) && !shard->draining; };
+    shard->ready.wait_for(lock, timeout,
+                          [&] { return drainable() || shard->stop; });
+    return drainable();
+}
+
+DispatchStats CallbackDispatcher::Stats() const {
+    DispatchStats stats;
+    stats.posted = posted_;
+    stats.executed = executed_;
+    stats.deferred = deferred_;
+    stats.rejected = rejected_;
+    stats.cancelled = cancelled_;
+    stats.high_water = high_water_;
+
+    std::shared_lock<std::shared_mutex> guard(policy_mtx_);
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        stats.depth += shard->size + shard->deferred.size();
+    }
+    return stats;
+}
+
+CallbackDispatcher::Shard& CallbackDispatcher::ShardFor(
+    const void* owner) const {
+    // Owners are heap objects; drop the always-zero alignment bits
+    const auto key =
+        reinterpret_cast<uintptr_t>(owner) / alignof(std::max_align_t);
+    return *shards_[key % shards_.size()];
+}
+
+CallbackDispatcher::Shard* CallbackDispatcher::TickShard() const {
+    std::shared_lock<std::shared_mutex> guard(policy_mtx_);
+    if (policy_.mode != DispatchPolicy::Mode::kTick) return nullptr;
+    return shards_.front().get();
+}
+
+void CallbackDispatcher::DeliverOne(Shard& shard,
+                                    std::unique_lock<std::mutex>& lock) {
+    Task task;
+    if (shard.size > 0) {
+        task = shard.ring[shard.head];
+        shard.head = (shard.head + 1) % shard.ring.size();
+        --shard.size;
+        if (task.state) --shard.states;
+        Refill(shard);
+    } else {
+        // Completions hold all the room; the deferred events are next
+        task = shard.deferred.front();
+        shard.deferred.pop_front();
+    }
+    shard.running = task.owner;
+    lock.unlock();
+
+    if (task.queued != std::chrono::steady_clock::time_point{}) {
+        if (LatencyHistogram* hist = WaitHistogram()) {
+            hist->Record(std::chrono::steady_clock::now() - task.queued);
+        }
+    }
+    const void* outer = std::exchange(t_delivering, task.owner);
+    task.fn(task.arg, task.data, true);
+    t_delivering = outer;
+    ++executed_;
+
+    lock.lock();
+    shard.running = nullptr;
+    shard.finished.notify_all();
+}
+
+void CallbackDispatcher::RunWorker(Shard& shard) {
+    // Callbacks may issue CA requests
+    ctx_.EnsureAttached();
+
+    std::unique_lock<std::mutex> lock(shard.mtx);
+    while (true) {
+        shard.ready.wait(lock,
+                         [&] { return Pending(shard) || shard.stop; });
+        if (!Pending(shard)) return;  // stopped and drained
+        DeliverOne(shard, lock);
+    }
+}
+
+void CallbackDispatcher::StopShards(
+    std::vector<std::unique_ptr<Shard>>& shards) {
+    for (auto& shard : shards) {
+        {
+            std::lock_guard<std::mutex> lock(shard->mtx);
+            shard->stop = true;
+        }
+        shard->ready.notify_all();
+        if (shard->worker.joinable()) {
+            // The worker delivers the rest before it exits
+            shard->worker.join();
+            continue;
+        }
+
+        // Tick mode: deliver the rest on this thread
+        std::lock_guard<std::mutex> drain(shard->drain_mtx);
+        std::unique_lock<std::mutex> lock(shard->mtx);
+        while (Pending(*shard)) DeliverOne(*shard, lock);
+    }
+}
+
+LatencyHistogram* CallbackDispatcher::WaitHistogram() {
+    Metrics* metrics = ctx_.GetMetrics();
+    if (!metrics) return nullptr;
+
+    LatencyHistogram* hist = wait_hist_.load(std::memory_order_acquire);
+    if (!hist) {
+        // Metrics::Get is idempotent, so a racing lookup is harmless
+        hist = metrics->Get("ca_dispatch_wait", "");
+        wait_hist_.store(hist, std::memory_order_release);
+    }
+    return hist;
+}
+
+}  // namespace bchtree::epics::ca
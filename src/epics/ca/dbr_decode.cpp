@@ -0,0 +1,244 @@
+#include "epics/ca/dbr_decode.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace bchtree::epics::ca {
+
+namespace {
+
+// Plain DBR_* buffers are the bare value; wrap them so every entry in the
+// table below can use v->value.
+template <typename E>
+struct Plain {
+    E value;
+};
+
+template <typename Dbr, typename = void>
+struct HasStatus : std::false_type {};
+template <typename Dbr>
+struct HasStatus<Dbr, std::void_t<decltype(std::declval<Dbr>().severity)>>
+    : std::true_type {};
+
+template <typename Dbr, typename = void>
+struct HasStamp : std::false_type {};
+template <typename Dbr>
+struct HasStamp<Dbr, std::void_t<decltype(std::declval<Dbr>().stamp)>>
+    : std::true_type {};
+
+template <typename Dbr, typename = void>
+struct HasUnits : std::false_type {};
+template <typename Dbr>
+struct HasUnits<Dbr, std::void_t<decltype(std::declval<Dbr>().units)>>
+    : std::true_type {};
+
+template <typename Dbr, typename = void>
+struct HasPrecision : std::false_type {};
+template <typename Dbr>
+struct HasPrecision<Dbr, std::void_t<decltype(std::declval<Dbr>().precision)>>
+    : std::true_type {};
+
+template <typename Dbr, typename = void>
+struct HasCtrlLimits : std::false_type {};
+template <typename Dbr>
+struct HasCtrlLimits<
+    Dbr, std::void_t<decltype(std::declval<Dbr>().upper_ctrl_limit)>>
+    : std::true_type {};
+
+template <typename Dbr, typename = void>
+struct HasEnumStrings : std::false_type {};
+template <typename Dbr>
+struct HasEnumStrings<Dbr, std::void_t<decltype(std::declval<Dbr>().strs)>>
+    : std::true_type {};
+
+std::chrono::system_clock::time_point ToTimePoint(const epicsTimeStamp& ts) {
+    const auto since_posix =
+        std::chrono::seconds(ts.secPastEpoch + POSIX_TIME_AT_EPICS_EPOCH) +
+        std::chrono::nanoseconds(ts.nsec);
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            since_posix));
+}
+
+// Scalar value of element type E
+template <typename E>
+PVData ScalarOf(const E* v) {
+    if constexpr (std::is_same_v<E, dbr_string_t>) {
+        return PVData::FromString(*v, MAX_STRING_SIZE);
+    } else if constexpr (std::is_same_v<E, dbr_double_t>) {
+        return PVData::FromDouble(*v);
+    } else if constexpr (std::is_same_v<E, dbr_float_t>) {
+        return PVData::FromFloat(*v);
+    } else if constexpr (std::is_same_v<E, dbr_enum_t>) {
+        return PVData::FromEnum(*v);
+    } else {
+        // DBR_CHAR, DBR_SHORT and DBR_LONG
+        return PVData::FromLong(static_cast<int32_t>(*v));
+    }
+}
+
+template <typename V, typename E>
+PVData ToArray(const E* first, long count) {
+    // Bulk range construction: a memcpy when V == E
+    return PVData::FromArray(
+        PVArrayValue{std::vector<V>(first, first + count)});
+}
+
+// Array value of element type E
+template <typename E>
+PVData ArrayOf(const E* first, long count) {
+    if constexpr (std::is_same_v<E, dbr_string_t>) {
+        std::vector<std::string> arr;
+        arr.reserve(count);
+        for (long i = 0; i < count; ++i) {
+            arr.emplace_back(first[i], strnlen(first[i], MAX_STRING_SIZE));
+        }
+        return PVData::FromArray(PVArrayValue{std::move(arr)});
+    } else if constexpr (std::is_same_v<E, dbr_double_t>) {
+        return ToArray<double>(first, count);
+    } else if constexpr (std::is_same_v<E, dbr_float_t>) {
+        return ToArray<float>(first, count);
+    } else if constexpr (std::is_same_v<E, dbr_enum_t>) {
+        return ToArray<uint16_t>(first, count);
+    } else if constexpr (std::is_same_v<E, dbr_char_t>) {
+        return ToArray<uint8_t>(first, count);
+    } else {
+        return ToArray<int32_t>(first, count);
+    }
+}
+
+template <typename Dbr>
+PVData Decode(long count, const void* raw, bool as_array) {
+    const auto* v = static_cast<const Dbr*>(raw);
+    using E = std::remove_cv_t<std::remove_reference_t<decltype(v->value)>>;
+
+    PVData data = as_array ? ArrayOf<E>(&v->value, std::max<long>(count, 1))
+                           : ScalarOf<E>(&v->value);
+    if constexpr (HasStatus<Dbr>::value) {
+        data.meta.status = static_cast<uint16_t>(v->status);
+        data.meta.severity = static_cast<uint16_t>(v->severity);
+    }
+    if constexpr (HasStamp<Dbr>::value) {
+        data.meta.timestamp = ToTimePoint(v->stamp);
+    }
+    data.count = static_cast<uint32_t>(std::max<long>(count, 1));
+    return data;
+}
+
+using Decoder = PVData (*)(long, const void*, bool);
+
+// Indexed by DBR type; the order follows db_access.h. The types after
+// DBR_CTRL_DOUBLE (alarm acknowledgement, class name) carry no value.
+constexpr std::array<Decoder, DBR_CTRL_DOUBLE + 1> kDecoders = {
+    // DBR_STRING .. DBR_DOUBLE
+    &Decode<Plain<dbr_string_t>>,
+    &Decode<Plain<dbr_short_t>>,
+    &Decode<Plain<dbr_float_t>>,
+    &Decode<Plain<dbr_enum_t>>,
+    &Decode<Plain<dbr_char_t>>,
+    &Decode<Plain<dbr_long_t>>,
+    &Decode<Plain<dbr_double_t>>,
+    // DBR_STS_*
+    &Decode<dbr_sts_string>,
+    &Decode<dbr_sts_short>,
+    &Decode<dbr_sts_float>,
+    &Decode<dbr_sts_enum>,
+    &Decode<dbr_sts_char>,
+    &Decode<dbr_sts_long>,
+    &Decode<dbr_sts_double>,
+    // DBR_TIME_*
+    &Decode<dbr_time_string>,
+    &Decode<dbr_time_short>,
+    &Decode<dbr_time_float>,
+    &Decode<dbr_time_enum>,
+    &Decode<dbr_time_char>,
+    &Decode<dbr_time_long>,
+    &Decode<dbr_time_double>,
+    // DBR_GR_* (strings have no graphic info and use the STS layout)
+    &Decode<dbr_sts_string>,
+    &Decode<dbr_gr_short>,
+    &Decode<dbr_gr_float>,
+    &Decode<dbr_gr_enum>,
+    &Decode<dbr_gr_char>,
+    &Decode<dbr_gr_long>,
+    &Decode<dbr_gr_double>,
+    // DBR_CTRL_*
+    &Decode<dbr_sts_string>,
+    &Decode<dbr_ctrl_short>,
+    &Decode<dbr_ctrl_float>,
+    &Decode<dbr_ctrl_enum>,
+    &Decode<dbr_ctrl_char>,
+    &Decode<dbr_ctrl_long>,
+    &Decode<dbr_ctrl_double>,
+};
+
+template <typename Dbr>
+PVControlInfo ControlInfo(const void* raw) {
+    const auto* v = static_cast<const Dbr*>(raw);
+    PVControlInfo info;
+    if constexpr (HasUnits<Dbr>::value) {
+        info.units.assign(v->units, strnlen(v->units, MAX_UNITS_SIZE));
+        info.display_low = v->lower_disp_limit;
+        info.display_high = v->upper_disp_limit;
+        info.alarm_low = v->lower_alarm_limit;
+        info.alarm_high = v->upper_alarm_limit;
+        info.warning_low = v->lower_warning_limit;
+        info.warning_high = v->upper_warning_limit;
+    }
+    if constexpr (HasPrecision<Dbr>::value) {
+        info.precision = v->precision;
+    }
+    if constexpr (HasCtrlLimits<Dbr>::value) {
+        info.control_low = v->lower_ctrl_limit;
+        info.control_high = v->upper_ctrl_limit;
+    }
+    if constexpr (HasEnumStrings<Dbr>::value) {
+        const int n = std::clamp<int>(v->no_str, 0, MAX_ENUM_STATES);
+        info.enum_strings.reserve(n);
+        for (int i = 0; i < n; ++i) {
+            info.enum_strings.emplace_back(
+                v->strs[i], strnlen(v->strs[i], MAX_ENUM_STRING_SIZE));
+        }
+    }
+    return info;
+}
+
+using InfoDecoder = PVControlInfo (*)(const void*);
+
+// Indexed by DBR type - DBR_GR_STRING
+constexpr std::array<InfoDecoder, DBR_CTRL_DOUBLE - DBR_GR_STRING + 1>
+    kInfoDecoders = {
+        &ControlInfo<dbr_sts_string>, &ControlInfo<dbr_gr_short>,
+        &ControlInfo<dbr_gr_float>,   &ControlInfo<dbr_gr_enum>,
+        &ControlInfo<dbr_gr_char>,    &ControlInfo<dbr_gr_long>,
+        &ControlInfo<dbr_gr_double>,  &ControlInfo<dbr_sts_string>,
+        &ControlInfo<dbr_ctrl_short>, &ControlInfo<dbr_ctrl_float>,
+        &ControlInfo<dbr_ctrl_enum>,  &ControlInfo<dbr_ctrl_char>,
+        &ControlInfo<dbr_ctrl_long>,  &ControlInfo<dbr_ctrl_double>,
+};
+
+}  // namespace
+
+PVControlInfo DecodeControlInfo(chtype type, const void* dbr) {
+    if (type < DBR_GR_STRING || type > DBR_CTRL_DOUBLE || !dbr) {
+        throw std::runtime_error("not a GR/CTRL DBR type " +
+                                 std::to_string(type));
+    }
+    return kInfoDecoders[type - DBR_GR_STRING](dbr);
+}
+
+PVData DecodeDbr(chtype type, long count, const void* dbr, bool as_array) {
+    if (type < 0 || type > DBR_CTRL_DOUBLE || !dbr) {
+        throw std::runtime_error("unsupported DBR type " +
+                                 std::to_string(type));
+    }
+    return kDecoders[type](count, dbr, as_array);
+}
+
+}  // namespace bchtree::epics::ca
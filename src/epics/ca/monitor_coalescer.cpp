@@ -0,0 +1,67 @@
+#include "epics/ca/monitor_coalescer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "epics/ca/ca_context_manager.h"
+#include "epics/ca/ca_pv.h"
+
+namespace bchtree::epics::ca {
+
+MonitorCoalescer::~MonitorCoalescer() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+void MonitorCoalescer::Schedule(CAPV* pv,
+                                std::chrono::steady_clock::time_point due) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (stop_) return;
+        auto [it, inserted] = pending_.emplace(pv, due);
+        if (!inserted && due < it->second) it->second = due;
+        if (!worker_.joinable()) worker_ = std::thread([this] { Run(); });
+    }
+    cv_.notify_all();
+}
+
+void MonitorCoalescer::Cancel(CAPV* pv) {
+    // Run() flushes under mtx_, so this also waits for a flush in progress
+    std::lock_guard<std::mutex> lock(mtx_);
+    pending_.erase(pv);
+}
+
+void MonitorCoalescer::Run() {
+    ctx_.EnsureAttached();
+
+    std::vector<CAPV*> due;
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (!stop_) {
+        if (pending_.empty()) {
+            cv_.wait(lock);
+            continue;
+        }
+
+        auto next = std::chrono::steady_clock::time_point::max();
+        for (const auto& [pv, when] : pending_) next = std::min(next, when);
+        if (cv_.wait_until(lock, next) != std::cv_status::timeout) continue;
+
+        const auto now = std::chrono::steady_clock::now();
+        due.clear();
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            if (it->second <= now) {
+                due.push_back(it->first);
+                it = pending_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (CAPV* pv : due) pv->FlushCoalesced();
+    }
+}
+
+}  // namespace bchtree::epics::ca
@@ -0,0 +1,69 @@
+#include "epics/ca/pv_group.h"
+
+#include <stdexcept>
+
+namespace bchtree::epics::ca {
+
+bool PVGroup::Resolve(const std::vector<std::string>& names) {
+    bool changed = names.size() != handles_.size();
+
+    if (handles_.size() > names.size()) {
+        handles_.resize(names.size());
+    }
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (i == handles_.size()) {
+            handles_.push_back(
+                std::make_unique<PVHandle>(pv_manager_, on_conn_, nullptr));
+        }
+        changed |= handles_[i]->Resolve(names[i]);
+    }
+    return changed;
+}
+
+bool PVGroup::ConnectAll() {
+    bool all_connected = true;
+    for (const auto& handle : handles_) {
+        if (!(*handle)->IsConnected()) {
+            (*handle)->Connect();
+            all_connected = false;
+        }
+    }
+    return all_connected;
+}
+
+std::vector<std::string> PVGroup::ExpandPattern(const std::string& pattern,
+                                                const std::string& range) {
+    const size_t slot = pattern.find("{}");
+    const size_t dots = range.find("..");
+    if (slot == std::string::npos || dots == std::string::npos) {
+        throw std::invalid_argument("PV pattern needs {} and range a..b: " +
+                                    pattern + " " + range);
+    }
+
+    const std::string first_str = range.substr(0, dots);
+    const std::string last_str = range.substr(dots + 2);
+    size_t used_first = 0;
+    size_t used_last = 0;
+    const long first = std::stol(first_str, &used_first);
+    const long last = std::stol(last_str, &used_last);
+    if (used_first != first_str.size() || used_last != last_str.size() ||
+        last < first) {
+        throw std::invalid_argument("invalid PV range: " + range);
+    }
+    const size_t width =
+        (first_str.size() > 1 && first_str[0] == '0') ? first_str.size() : 0;
+
+    std::vector<std::string> names;
+    names.reserve(static_cast<size_t>(last - first + 1));
+    for (long i = first; i <= last; ++i) {
+        std::string index = std::to_string(i);
+        if (index.size() < width) {
+            index.insert(0, width - index.size(), '0');
+        }
+        names.push_back(pattern.substr(0, slot) + index +
+                        pattern.substr(slot + 2));
+    }
+    return names;
+}
+
+}  // namespace bchtree::epics::ca
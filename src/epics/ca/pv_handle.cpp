@@ -0,0 +1,58 @@
+#include "epics/ca/pv_handle.h"
+
+namespace bchtree::epics::ca {
+
+PVHandle::PVHandle(std::shared_ptr<PVManager> pv_manager, ConnCallback on_conn,
+                   MonitorCallback on_monitor)
+    : pv_manager_(std::move(pv_manager)),
+      on_conn_(std::move(on_conn)),
+      on_monitor_(std::move(on_monitor)),
+      token_(std::make_shared<RequestToken>()) {}
+
+PVHandle::~PVHandle() {
+    token_->Revoke();
+    Release();
+}
+
+bool PVHandle::Resolve(std::string_view pv_name) {
+    if (pv_ && pv_name == name_) {
+        return false;
+    }
+
+    Release();
+
+    name_.assign(pv_name.data(), pv_name.size());
+    hash_ = PVManager::Hash(name_);
+    pv_ = pv_manager_->Get(name_, hash_);
+    if (monitor_policy_) {
+        pv_->ApplyMonitorPolicy(*monitor_policy_);
+    }
+    if (on_conn_) {
+        conn_cb_id_ = pv_->AddConnCB(on_conn_);
+    }
+    if (on_monitor_) {
+        monitor_cb_id_ = pv_->AddMonitorCB(on_monitor_);
+    }
+    return true;
+}
+
+void PVHandle::SetMonitorPolicy(const MonitorPolicy& policy) {
+    monitor_policy_ = policy;
+    if (pv_) pv_->ApplyMonitorPolicy(policy);
+}
+
+void PVHandle::Release() {
+    if (!pv_) return;
+
+    if (conn_cb_id_) {
+        pv_->RemoveConnCB(conn_cb_id_);
+        conn_cb_id_ = 0;
+    }
+    if (monitor_cb_id_) {
+        pv_->RemoveMonitorCB(monitor_cb_id_);
+        monitor_cb_id_ = 0;
+    }
+    pv_.reset();
+}
+
+}  // namespace bchtree::epics::ca
@@ -1,10 +1,13 @@
 #include "logger.h"
 
+#include <spdlog/async_logger.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 namespace bchtree {
@@ -20,6 +23,37 @@ spdlog::level::level_enum Logger::to_level(const std::string& level) {
     return spdlog::level::info;
 }
 
+LogOverflowPolicy Logger::to_overflow_policy(const std::string& policy) {
+    if (policy == "drop") return LogOverflowPolicy::kDrop;
+    if (policy == "sample") return LogOverflowPolicy::kSample;
+    if (policy == "block") return LogOverflowPolicy::kBlock;
+    throw std::invalid_argument("unknown log overflow policy [" + policy +
+                                "]");
+}
+
+void Logger::setAsync(size_t queue_size, const std::string& policy) {
+    const LogOverflowPolicy overflow = to_overflow_policy(policy);
+    if (queue_size == 0) {
+        throw std::invalid_argument("log queue size must be > 0");
+    }
+    async_ = true;
+    queue_size_ = queue_size;
+    overflow_policy_ = overflow;
+    if (initialized_) {
+        rebuild_logger();
+    }
+}
+
+size_t Logger::droppedCount() const {
+    size_t dropped = sampled_out_;
+    if (thread_pool_) {
+        dropped += thread_pool_->overrun_counter();
+    }
+    return dropped;
+}
+
+size_t Logger::sampledCount() const { return sampled_out_; }
+
 void Logger::setConsoleLevel(const std::string& level) {
     console_level_ = to_level(level);
     if (initialized_) {
@@ -65,14 +99,32 @@ void Logger::rebuild_logger() {
 
     // Create or replace the dedicated logger instance (do not change default
     // logger)
-    logger_ =
-        std::make_shared<spdlog::logger>("bt", sinks.begin(), sinks.end());
+    if (async_) {
+        // Flush the old logger first so nothing queued is lost on rebuild
+        if (logger_) {
+            logger_->flush();
+        }
+        logger_.reset();
+        thread_pool_ =
+            std::make_shared<spdlog::details::thread_pool>(queue_size_, 1);
+        const auto policy = (overflow_policy_ == LogOverflowPolicy::kBlock)
+                                ? spdlog::async_overflow_policy::block
+                                : spdlog::async_overflow_policy::overrun_oldest;
+        logger_ = std::make_shared<spdlog::async_logger>(
+            "bt", sinks.begin(), sinks.end(), thread_pool_, policy);
+    } else {
+        logger_ =
+            std::make_shared<spdlog::logger>("bt", sinks.begin(), sinks.end());
+    }
 
     // Apply pattern to this logger explicitly
     logger_->set_pattern("%Y-%m-%dT%H:%M:%S.%e %z [%l] %v");
 
-    // Set logger level permissive; sinks filter effectively
-    logger_->set_level(spdlog::level::trace);
+    // Pass only what some sink keeps, so filtered messages are neither
+    // formatted nor queued
+    auto level = console_level_;
+    if (!file_path_.empty()) level = std::min(level, file_level_);
+    logger_->set_level(level);
     logger_->flush_on(spdlog::level::info);
 }
 
@@ -88,12 +140,23 @@ void Logger::error(const std::string& msg) {
     ensure_init();
     logger_->error(msg);
 }
-void Logger::debug(const std::string& msg) {
+bool Logger::should_log(spdlog::level::level_enum level) {
+    ensure_init();
+    return logger_->should_log(level);
+}
+// Level first, so filtered messages are not counted as sampled out
+void Logger::debug(std::string_view msg) {
     ensure_init();
+    if (!logger_->should_log(spdlog::level::debug) || !should_sample()) {
+        return;
+    }
     logger_->debug(msg);
 }
-void Logger::trace(const std::string& msg) {
+void Logger::trace(std::string_view msg) {
     ensure_init();
+    if (!logger_->should_log(spdlog::level::trace) || !should_sample()) {
+        return;
+    }
     logger_->trace(msg);
 }
 void Logger::critical(const std::string& msg) {
@@ -101,6 +164,21 @@ void Logger::critical(const std::string& msg) {
     logger_->critical(msg);
 }
 
+bool Logger::should_sample() {
+    if (overflow_policy_ != LogOverflowPolicy::kSample || !thread_pool_) {
+        return true;
+    }
+    // Pass everything until the queue is half full
+    if (thread_pool_->queue_size() < queue_size_ / 2) {
+        return true;
+    }
+    if (sample_counter_++ % kSampleEvery == 0) {
+        return true;
+    }
+    ++sampled_out_;
+    return false;
+}
+
 void Logger::flush() {
     // Flush the dedicated logger only
     if (logger_) {
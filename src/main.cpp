@@ -1,9 +1,14 @@
+#include <algorithm>
 #include <chrono>
+#include <csignal>
 #include <cxxopts.hpp>
 #include <iostream>
 
 #include "bt_runner.h"
+#include "daemon_server.h"
 #include "logger.h"
+#include "metrics.h"
+#include "tree_supervisor.h"
 
 enum ExitCode {
     OK = 0,            // Tree SUCCESS
@@ -11,24 +16,62 @@ enum ExitCode {
     USAGE_ERROR = 2,   // argument error (--tree missing etc.)
 };
 
+namespace {
+// SIGUSR1 asks the runner to write the metrics file between ticks
+bchtree::Metrics* g_metrics = nullptr;
+void OnDumpSignal(int) {
+    if (g_metrics) g_metrics->RequestDump();
+}
+
+// SIGINT/SIGTERM stop a daemon after its running trees finish
+bchtree::DaemonServer* g_daemon = nullptr;
+void OnStopSignal(int) {
+    if (g_daemon) g_daemon->Stop();
+}
+}  // namespace
+
 int main(int argc, char** argv) {
     cxxopts::Options options("bch-tree-cli", "bch-tree CLI Runner");
 
     // clang-format off
     options.add_options()
-      ("t,tree", "XML tree file", cxxopts::value<std::string>())
+      ("t,tree", "XML tree file. Repeatable; several trees run concurrently sharing CA channels.", cxxopts::value<std::vector<std::string>>())
+      ("threads", "worker threads for multiple trees (0: one per tree)", cxxopts::value<int>()->default_value("0"))
       ("log-level-console", "(trace|debug|info|warn|error|critical|off)", cxxopts::value<std::string>()->default_value("info"))
       ("log-level-file", "(trace|debug|info|warn|error|critical|off)", cxxopts::value<std::string>()->default_value("info"))
       ("log-file", "log file path", cxxopts::value<std::string>()->default_value(""))
+      ("log-async", "write logs from a background thread", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("log-queue-size", "async log queue size in messages", cxxopts::value<int>()->default_value("8192"))
+      ("log-overflow", "async log queue full policy (block|drop|sample)", cxxopts::value<std::string>()->default_value("block"))
+      ("trace-file", "binary trace ring file (decode with bch-trace-decode)", cxxopts::value<std::string>()->default_value(""))
+      ("trace-capacity", "trace ring size in records", cxxopts::value<int>()->default_value("65536"))
+      ("metrics-file", "write latency metrics on exit and on SIGUSR1", cxxopts::value<std::string>()->default_value(""))
+      ("metrics-format", "(json|prometheus)", cxxopts::value<std::string>()->default_value("json"))
       ("print-tree", "print tree", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
       ("s,set", "Set global blackboard entry (key=value). Repeatable.", cxxopts::value<std::vector<std::string>>()->default_value({}))
       ("sleep-time", "sleep time for tick in msec", cxxopts::value<int>()->default_value("10"))
+      ("tick-mode", "(poll|event) poll re-ticks every sleep-time, event waits for CA callbacks", cxxopts::value<std::string>()->default_value("poll"))
+      ("max-idle", "max wait between ticks in event mode in msec", cxxopts::value<int>()->default_value("100"))
+      ("prewarm-percent", "wait until this percentage of PVs are connected before running", cxxopts::value<int>()->default_value("0"))
+      ("prewarm-timeout", "max wait for --prewarm-percent in msec", cxxopts::value<int>()->default_value("5000"))
+      ("hot-reload", "rebuild the tree when its XML (or an include) changes, keeping CA channels", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("linger-channels", "keep up to this many released CA channels connected for reuse (default 0, 1024 with --daemon)", cxxopts::value<int>())
+      ("linger-idle", "close lingering CA channels unused for this many msec", cxxopts::value<int>()->default_value("600000"))
+      ("monitor", "default CA monitor policy, e.g. lazy or value,100ms (off|lazy|on, value|log, <N>ms)", cxxopts::value<std::string>()->default_value("on"))
+      ("ca-dispatch", "run CA callbacks on CA threads (inline), between ticks (tick) or on N dispatcher threads", cxxopts::value<std::string>()->default_value("inline"))
+      ("ca-dispatch-queue", "CA callback ring size per dispatcher; gets and puts beyond it are refused", cxxopts::value<int>()->default_value("4096"))
+      ("daemon", "stay resident and run trees submitted on this Unix socket", cxxopts::value<std::string>()->default_value(""))
+      ("connect", "submit --tree (and --set) to the daemon on this Unix socket", cxxopts::value<std::string>()->default_value(""))
       ("h,help", "print usage");
     // clang-format on
 
     auto result = options.parse(argc, argv);
 
-    if (result.count("help") || !result.count("tree")) {
+    const auto daemon_socket = result["daemon"].as<std::string>();
+    const auto connect_socket = result["connect"].as<std::string>();
+
+    if (result.count("help") ||
+        (!result.count("tree") && daemon_socket.empty())) {
         std::cout << options.help() << std::endl;
         return USAGE_ERROR;
     }
@@ -42,24 +85,57 @@ int main(int argc, char** argv) {
     logger->setConsoleLevel(console_level);
     logger->setFileLevel(file_level);
 
+    const int log_queue_size = result["log-queue-size"].as<int>();
+    if (log_queue_size <= 0) {
+        logger->error("Invalid --log-queue-size '" +
+                      std::to_string(log_queue_size) + "'. Expected > 0.");
+        return USAGE_ERROR;
+    }
+    const auto log_overflow = result["log-overflow"].as<std::string>();
+    if (log_overflow != "block" && log_overflow != "drop" &&
+        log_overflow != "sample") {
+        logger->error(std::string("Invalid --log-overflow '") +
+                      log_overflow + "'. Expected block, drop or sample.");
+        return USAGE_ERROR;
+    }
+    if (result["log-async"].as<bool>()) {
+        logger->setAsync(static_cast<size_t>(log_queue_size), log_overflow);
+    }
+
     auto logfile = result["log-file"].as<std::string>();
     if (!logfile.empty()) {
         logger->setFile(logfile);
     }
 
-    auto ctx = std::make_shared<bchtree::epics::ca::CAContextManager>();
-    ctx->Init();
-    auto pv_manager = std::make_shared<bchtree::epics::ca::PVManager>(ctx);
+    const auto metrics_file = result["metrics-file"].as<std::string>();
+    const auto metrics_format = result["metrics-format"].as<std::string>();
+    if (metrics_format != "json" && metrics_format != "prometheus") {
+        logger->error(std::string("Invalid --metrics-format '") +
+                      metrics_format + "'. Expected json or prometheus.");
+        return USAGE_ERROR;
+    }
 
-    bchtree::BTRunner runner(ctx, pv_manager);
-    runner.SetLogger(logger);
+    const auto tick_mode = result["tick-mode"].as<std::string>();
+    const auto max_idle =
+        std::chrono::milliseconds(result["max-idle"].as<int>());
+    if (tick_mode != "poll" && tick_mode != "event") {
+        logger->error(std::string("Invalid --tick-mode '") + tick_mode +
+                      "'. Expected poll or event.");
+        return USAGE_ERROR;
+    }
 
-    if (console_level == "debug" || file_level == "debug") {
-        runner.UseRunnerLogger();
+    const auto linger_idle =
+        std::chrono::milliseconds(result["linger-idle"].as<int>());
+    if (linger_idle.count() < 0) {
+        logger->error("Invalid --linger-idle '" +
+                      std::to_string(linger_idle.count()) +
+                      "'. Expected >= 0.");
+        return USAGE_ERROR;
     }
 
-    // Parse --set key=value pairs and pass them to BTRunner BEFORE
+    // Parse --set key=value pairs; they are passed to each BTRunner BEFORE
     // RegisterTreeFromFile().
+    std::vector<std::pair<std::string, std::string>> globals;
     if (result.count("set")) {
         const auto pairs = result["set"].as<std::vector<std::string>>();
         for (const auto& kv : pairs) {
@@ -70,24 +146,212 @@ int main(int argc, char** argv) {
                               "'. Expected key=value.");
                 return USAGE_ERROR;
             }
-            const std::string key = kv.substr(0, pos);
-            const std::string val = kv.substr(pos + 1);
             // Note: keys are plain strings (e.g., "@head", "mode", etc.)
-            runner.SetGlobalBB(key, val);
+            globals.emplace_back(kv.substr(0, pos), kv.substr(pos + 1));
         }
     }
 
-    const std::string treePath = result["tree"].as<std::string>();
-    runner.RegisterTreeFromFile(treePath);
+    const auto tree_paths =
+        result.count("tree") ? result["tree"].as<std::vector<std::string>>()
+                             : std::vector<std::string>{};
 
-    if (result["print-tree"].as<bool>()) {
-        runner.PrintTree();
-        return OK;
+    if (!connect_socket.empty()) {
+        // Client: the daemon does the work, we only report its reply
+        bool all_success = true;
+        for (const auto& treePath : tree_paths) {
+            try {
+                const auto reply = bchtree::SubmitToDaemon(
+                    connect_socket, {treePath, globals});
+                if (reply.status == "ERROR") {
+                    logger->error(treePath + ": " + reply.error);
+                    all_success = false;
+                    continue;
+                }
+                std::cout << treePath << " " << reply.status
+                          << " load_ms=" << reply.load_ms
+                          << " run_ms=" << reply.run_ms << std::endl;
+                all_success = all_success && reply.status == "SUCCESS";
+            } catch (const std::exception& e) {
+                logger->error(e.what());
+                return TREE_FAILURE;
+            }
+        }
+        return all_success ? OK : TREE_FAILURE;
+    }
+
+    const auto trace_file = result["trace-file"].as<std::string>();
+    if (!daemon_socket.empty() && !trace_file.empty()) {
+        logger->error("--trace-file cannot be used with --daemon");
+        return USAGE_ERROR;
+    }
+    const int trace_capacity = result["trace-capacity"].as<int>();
+    if (trace_capacity <= 0) {
+        logger->error("Invalid --trace-capacity '" +
+                      std::to_string(trace_capacity) + "'. Expected > 0.");
+        return USAGE_ERROR;
+    }
+
+    auto ctx = std::make_shared<bchtree::epics::ca::CAContextManager>();
+    ctx->Init();
+    ctx->SetLogger(logger);
+
+    try {
+        // Before any channel exists
+        auto dispatch = bchtree::epics::ca::DispatchPolicy::Parse(
+            result["ca-dispatch"].as<std::string>());
+        dispatch.capacity = static_cast<size_t>(
+            std::max(result["ca-dispatch-queue"].as<int>(), 1));
+        ctx->Dispatcher().SetPolicy(dispatch);
+    } catch (const std::invalid_argument& e) {
+        logger->error(std::string("Invalid --ca-dispatch: ") + e.what());
+        return USAGE_ERROR;
+    }
+
+    std::shared_ptr<bchtree::Metrics> metrics;
+    if (!metrics_file.empty()) {
+        // Must be set before any PV is created
+        metrics = std::make_shared<bchtree::Metrics>();
+        ctx->SetMetrics(metrics);
+        g_metrics = metrics.get();
+        std::signal(SIGUSR1, OnDumpSignal);
+    }
+
+    auto pv_manager = std::make_shared<bchtree::epics::ca::PVManager>(ctx);
+    try {
+        pv_manager->SetDefaultMonitorPolicy(
+            bchtree::epics::ca::MonitorPolicy::Parse(
+                result["monitor"].as<std::string>()));
+    } catch (const std::invalid_argument& e) {
+        logger->error(std::string("Invalid --monitor: ") + e.what());
+        return USAGE_ERROR;
     }
+    // A daemon's runs release their channels; keep them for the next run
+    size_t linger_channels =
+        daemon_socket.empty() ? 0
+                              : bchtree::DaemonServer::kDefaultLingerChannels;
+    if (result.count("linger-channels")) {
+        linger_channels = static_cast<size_t>(
+            std::max(result["linger-channels"].as<int>(), 0));
+    }
+    pv_manager->SetLingerPolicy({linger_channels, linger_idle});
+
+    // Per-tree options shared by the single and multi-tree paths
+    auto configure = [&](bchtree::BTRunner& runner, size_t index) {
+        if (!trace_file.empty()) {
+            // One ring per tree; the first keeps the given name
+            runner.UseTraceRecorder(
+                index == 0 ? trace_file
+                           : trace_file + "." + std::to_string(index),
+                static_cast<size_t>(trace_capacity));
+        }
+        if (tick_mode == "event") {
+            runner.SetTickMode(bchtree::TickMode::kEvent, max_idle);
+        }
+        if (console_level == "debug" || file_level == "debug") {
+            runner.UseRunnerLogger();
+        }
+        for (const auto& [key, val] : globals) {
+            runner.SetGlobalBB(key, val);
+        }
+        if (result["hot-reload"].as<bool>()) {
+            runner.EnableHotReload();
+        }
+        runner.SetPrewarmWait(
+            result["prewarm-percent"].as<int>() / 100.0,
+            std::chrono::milliseconds(result["prewarm-timeout"].as<int>()));
+    };
 
     auto sleep_time_arg = result["sleep-time"].as<int>();
     auto sleep_time = std::chrono::milliseconds(sleep_time_arg);
-    bool success = runner.Run(sleep_time);
+
+    if (!daemon_socket.empty()) {
+        // Keep the CA context and channels warm across submitted trees
+        bchtree::DaemonServer server(ctx, pv_manager);
+        server.SetLogger(logger);
+        server.SetRunnerConfig([&](bchtree::BTRunner& runner) {
+            configure(runner, 0);
+            if (metrics) {
+                runner.SetMetrics(metrics, metrics_file, metrics_format);
+            }
+        });
+        try {
+            server.Listen(daemon_socket);
+        } catch (const std::exception& e) {
+            logger->error(e.what());
+            return USAGE_ERROR;
+        }
+
+        g_daemon = &server;
+        std::signal(SIGINT, OnStopSignal);
+        std::signal(SIGTERM, OnStopSignal);
+        server.Serve(sleep_time);
+        g_daemon = nullptr;
+
+        logger->info("Daemon: stopped");
+        logger->flush();
+        return OK;
+    }
+
+    if (result["print-tree"].as<bool>()) {
+        for (const auto& treePath : tree_paths) {
+            bchtree::BTRunner runner(ctx, pv_manager);
+            runner.SetLogger(logger);
+            runner.RegisterTreeFromFile(treePath);
+            runner.PrintTree();
+        }
+        return OK;
+    }
+
+    bool success = false;
+    if (tree_paths.size() > 1) {
+        // Several trees share this process's CA context and channels
+        bchtree::TreeSupervisor supervisor(ctx, pv_manager);
+        supervisor.SetLogger(logger);
+        supervisor.SetThreadCount(result["threads"].as<int>());
+        if (metrics) {
+            supervisor.SetMetrics(metrics, metrics_file, metrics_format);
+        }
+        try {
+            for (size_t i = 0; i < tree_paths.size(); ++i) {
+                configure(supervisor.AddTree(tree_paths[i]), i);
+            }
+        } catch (const std::exception& e) {
+            // Colliding tree names, or a trace file that cannot be created
+            logger->error(e.what());
+            return USAGE_ERROR;
+        }
+        success = supervisor.RunAll(sleep_time);
+    } else {
+        bchtree::BTRunner runner(ctx, pv_manager);
+        runner.SetLogger(logger);
+        if (metrics) {
+            runner.SetMetrics(metrics, metrics_file, metrics_format);
+        }
+        try {
+            configure(runner, 0);
+        } catch (const std::exception& e) {
+            logger->error(e.what());
+            return USAGE_ERROR;
+        }
+        runner.RegisterTreeFromFile(tree_paths.front());
+        success = runner.Run(sleep_time);
+    }
+
+    if (const auto stats = ctx->Dispatcher().Stats();
+        stats.deferred > 0 || stats.rejected > 0) {
+        logger->warn("CA dispatch: " + std::to_string(stats.deferred) +
+                     " events waited for room and " +
+                     std::to_string(stats.rejected) +
+                     " requests were refused (high water " +
+                     std::to_string(stats.high_water) +
+                     "); consider a larger --ca-dispatch-queue");
+    }
+    if (const size_t dropped = logger->droppedCount(); dropped > 0) {
+        logger->warn("Logger: dropped " + std::to_string(dropped) +
+                     " messages");
+    }
+    logger->flush();
+
     if (success) {
         return OK;
     }
@@ -0,0 +1,175 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace bchtree {
+
+namespace {
+
+int Log2Floor(uint64_t v) { return 63 - __builtin_clzll(v); }
+
+std::string Escape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out.push_back(c);
+        }
+    }
+    return out;
+}
+
+constexpr double kQuantiles[] = {50.0, 90.0, 99.0, 99.9};
+
+}  // namespace
+
+size_t LatencyHistogram::BucketIndex(uint64_t value) {
+    if (value < kSubBuckets) {
+        return static_cast<size_t>(value);
+    }
+    const int e = Log2Floor(value);
+    const size_t sub = (value >> (e - kSubBucketBits)) & (kSubBuckets - 1);
+    return kSubBuckets + (e - kSubBucketBits) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    const size_t e = (index - kSubBuckets) / kSubBuckets + kSubBucketBits;
+    const uint64_t sub = (index - kSubBuckets) % kSubBuckets;
+    const int shift = static_cast<int>(e) - kSubBucketBits;
+    const uint64_t lower = (kSubBuckets + sub) << shift;
+    return lower + ((uint64_t{1} << shift) - 1);
+}
+
+void LatencyHistogram::Record(uint64_t value_ns) {
+    counts_[BucketIndex(value_ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value_ns, std::memory_order_relaxed);
+
+    uint64_t cur = min_.load(std::memory_order_relaxed);
+    while (value_ns < cur &&
+           !min_.compare_exchange_weak(cur, value_ns,
+                                       std::memory_order_relaxed)) {
+    }
+    cur = max_.load(std::memory_order_relaxed);
+    while (value_ns > cur &&
+           !max_.compare_exchange_weak(cur, value_ns,
+                                       std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::Record(std::chrono::steady_clock::duration d) {
+    const auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    Record(static_cast<uint64_t>(ns < 0 ? 0 : ns));
+}
+
+uint64_t LatencyHistogram::Min() const {
+    const uint64_t v = min_.load(std::memory_order_relaxed);
+    return v == UINT64_MAX ? 0 : v;
+}
+
+uint64_t LatencyHistogram::Percentile(double p) const {
+    const uint64_t total = Count();
+    if (total == 0) return 0;
+
+    const auto rank = static_cast<uint64_t>(p / 100.0 * total + 0.5);
+    const uint64_t target = rank == 0 ? 1 : rank;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(BucketUpperBound(i), Max());
+        }
+    }
+    return Max();
+}
+
+LatencyHistogram* Metrics::Get(const std::string& family,
+                               const std::string& label) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto& hist = histograms_[{family, label}];
+    if (!hist) {
+        hist = std::make_unique<LatencyHistogram>();
+    }
+    return hist.get();
+}
+
+std::string Metrics::ToJson() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::ostringstream os;
+    os << "{";
+    std::string family;
+    bool first_family = true;
+    bool first_label = true;
+    for (const auto& [key, hist] : histograms_) {
+        if (key.first != family || first_family) {
+            if (!first_family) os << "}";
+            os << (first_family ? "\n" : ",\n") << "  \"" << Escape(key.first)
+               << "\": {";
+            family = key.first;
+            first_family = false;
+            first_label = true;
+        }
+        os << (first_label ? "\n" : ",\n") << "    \"" << Escape(key.second)
+           << "\": {\"count\": " << hist->Count()
+           << ", \"sum_ns\": " << hist->Sum() << ", \"min_ns\": " << hist->Min()
+           << ", \"max_ns\": " << hist->Max();
+        for (double q : kQuantiles) {
+            os << ", \"p" << q << "_ns\": " << hist->Percentile(q);
+        }
+        os << "}";
+        first_label = false;
+    }
+    if (!first_family) os << "}";
+    os << "\n}\n";
+    return os.str();
+}
+
+std::string Metrics::ToPrometheus() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::ostringstream os;
+    std::string family;
+    for (const auto& [key, hist] : histograms_) {
+        const std::string name = "bchtree_" + key.first + "_seconds";
+        if (key.first != family) {
+            os << "# TYPE " << name << " summary\n";
+            family = key.first;
+        }
+        const std::string label = "name=\"" + Escape(key.second) + "\"";
+        for (double q : kQuantiles) {
+            os << name << "{" << label << ",quantile=\"" << q / 100.0
+               << "\"} " << hist->Percentile(q) / 1e9 << "\n";
+        }
+        os << name << "_sum{" << label << "} " << hist->Sum() / 1e9 << "\n";
+        os << name << "_count{" << label << "} " << hist->Count() << "\n";
+    }
+    return os.str();
+}
+
+bool Metrics::WriteFile(const std::string& path,
+                        const std::string& format) const {
+    // Concurrent runners may dump to the same file
+    std::lock_guard<std::mutex> lock(write_mtx_);
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream ofs(tmp, std::ios::trunc);
+        if (!ofs) return false;
+        ofs << (format == "prometheus" ? ToPrometheus() : ToJson());
+        if (!ofs) return false;
+    }
+    // Readers never observe a half-written file
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+}  // namespace bchtree
@@ -0,0 +1,115 @@
+#include <cxxopts.hpp>
+#include <iostream>
+#include <string>
+
+#include "trace_recorder.h"
+
+enum ExitCode {
+    OK = 0,
+    DECODE_ERROR = 1,
+    USAGE_ERROR = 2,
+};
+
+namespace {
+
+const char* StatusName(uint8_t status) {
+    return bchtree::StatusName(static_cast<BT::NodeStatus>(status));
+}
+
+std::string NodeName(const std::vector<std::string>& names, uint16_t uid) {
+    if (uid < names.size() && !names[uid].empty()) {
+        return names[uid];
+    }
+    return "uid" + std::to_string(uid);
+}
+
+std::string JsonEscape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        if (c == '"' || c == '\\') out.push_back('\\');
+        out.push_back(c);
+    }
+    return out;
+}
+
+void PrintText(const bchtree::TraceReader& reader) {
+    const auto names = reader.NodeNames();
+    for (const auto& rec : reader.Records()) {
+        const double ms = (rec.timestamp_ns - reader.StartNs()) / 1e6;
+        std::cout << std::fixed << ms << " ms  "
+                  << NodeName(names, rec.node_uid) << "  "
+                  << StatusName(rec.prev_status) << " -> "
+                  << StatusName(rec.status) << "\n";
+    }
+}
+
+// Chrome trace event format (chrome://tracing, Perfetto): a node's RUNNING
+// span becomes a B/E pair on its own track, other transitions are instants.
+void PrintChrome(const bchtree::TraceReader& reader) {
+    constexpr auto kRunning = static_cast<uint8_t>(BT::NodeStatus::RUNNING);
+    const auto names = reader.NodeNames();
+
+    std::cout << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& rec : reader.Records()) {
+        const char* phase = "i";
+        if (rec.status == kRunning) {
+            phase = "B";
+        } else if (rec.prev_status == kRunning) {
+            phase = "E";
+        }
+        const double us = (rec.timestamp_ns - reader.StartNs()) / 1e3;
+
+        std::cout << (first ? "" : ",\n") << "{\"name\":\""
+                  << JsonEscape(NodeName(names, rec.node_uid))
+                  << "\",\"ph\":\"" << phase << "\",\"ts\":" << std::fixed
+                  << us << ",\"pid\":1,\"tid\":" << rec.node_uid
+                  << ",\"args\":{\"from\":\"" << StatusName(rec.prev_status)
+                  << "\",\"to\":\"" << StatusName(rec.status) << "\"}}";
+        first = false;
+    }
+    std::cout << "\n]}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    cxxopts::Options options("bch-trace-decode",
+                             "Decode a bch-tree binary trace file");
+
+    // clang-format off
+    options.add_options()
+      ("i,input", "trace file written with --trace-file", cxxopts::value<std::string>())
+      ("f,format", "(text|chrome)", cxxopts::value<std::string>()->default_value("text"))
+      ("h,help", "print usage");
+    // clang-format on
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help") || !result.count("input")) {
+        std::cout << options.help() << std::endl;
+        return USAGE_ERROR;
+    }
+
+    const auto format = result["format"].as<std::string>();
+    if (format != "text" && format != "chrome") {
+        std::cerr << "Invalid --format '" << format
+                  << "'. Expected text or chrome." << std::endl;
+        return USAGE_ERROR;
+    }
+
+    try {
+        bchtree::TraceReader reader(result["input"].as<std::string>());
+        if (format == "chrome") {
+            PrintChrome(reader);
+        } else {
+            PrintText(reader);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return DECODE_ERROR;
+    }
+
+    return OK;
+}
@@ -0,0 +1,190 @@
+#include "trace_recorder.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <stdexcept>
+
+namespace bchtree {
+
+namespace {
+uint64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+}  // namespace
+
+const char* StatusName(BT::NodeStatus status) {
+    switch (status) {
+        case BT::NodeStatus::IDLE:
+            return "IDLE";
+        case BT::NodeStatus::RUNNING:
+            return "RUNNING";
+        case BT::NodeStatus::SUCCESS:
+            return "SUCCESS";
+        case BT::NodeStatus::FAILURE:
+            return "FAILURE";
+        case BT::NodeStatus::SKIPPED:
+            return "SKIPPED";
+    }
+    return "Undefined";
+}
+
+TraceRecorder::TraceRecorder(const std::string& path, size_t capacity)
+    : path_(path) {
+    if (capacity == 0) {
+        throw std::runtime_error("TraceRecorder: capacity must be > 0");
+    }
+    // The mapping size must neither wrap nor exceed what off_t can hold
+    constexpr size_t kMaxBytes = static_cast<size_t>(
+        std::min<uintmax_t>(std::numeric_limits<size_t>::max(),
+                            std::numeric_limits<off_t>::max()));
+    if (capacity >
+        (kMaxBytes - sizeof(TraceFileHeader)) / sizeof(TraceRecord)) {
+        throw std::runtime_error("TraceRecorder: capacity " +
+                                 std::to_string(capacity) + " is too large");
+    }
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ == -1) {
+        throw std::runtime_error("TraceRecorder: cannot open " + path);
+    }
+
+    map_size_ = sizeof(TraceFileHeader) + capacity * sizeof(TraceRecord);
+    if (::ftruncate(fd_, static_cast<off_t>(map_size_)) == -1) {
+        ::close(fd_);
+        throw std::runtime_error("TraceRecorder: ftruncate failed for " +
+                                 path);
+    }
+
+    void* addr = ::mmap(nullptr, map_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED) {
+        ::close(fd_);
+        throw std::runtime_error("TraceRecorder: mmap failed for " + path);
+    }
+
+    // File is zero-filled by ftruncate, so every record starts with seq 0
+    header_ = new (addr) TraceFileHeader{};
+    std::memcpy(header_->magic, TraceFileHeader::kMagic,
+                sizeof(header_->magic));
+    header_->version = TraceFileHeader::kVersion;
+    header_->record_size = sizeof(TraceRecord);
+    header_->capacity = capacity;
+    header_->start_ns = NowNs();
+    header_->write_index.store(0);
+
+    records_ = reinterpret_cast<TraceRecord*>(static_cast<char*>(addr) +
+                                              sizeof(TraceFileHeader));
+}
+
+TraceRecorder::~TraceRecorder() {
+    if (header_) {
+        ::msync(header_, map_size_, MS_ASYNC);
+        ::munmap(header_, map_size_);
+    }
+    if (fd_ != -1) {
+        ::close(fd_);
+    }
+}
+
+void TraceRecorder::Record(uint16_t node_uid, uint8_t prev_status,
+                           uint8_t status) {
+    const uint64_t idx =
+        header_->write_index.fetch_add(1, std::memory_order_relaxed);
+    TraceRecord& rec = records_[idx % header_->capacity];
+
+    // Invalidate first so a reader never pairs the old seq with new fields
+    __atomic_store_n(&rec.seq, 0, __ATOMIC_RELAXED);
+    rec.timestamp_ns = NowNs();
+    rec.node_uid = node_uid;
+    rec.prev_status = prev_status;
+    rec.status = status;
+    __atomic_store_n(&rec.seq, idx + 1, __ATOMIC_RELEASE);
+}
+
+void TraceRecorder::WriteNodeNames(const BT::Tree& tree) {
+    std::ofstream ofs(path_ + ".names", std::ios::trunc);
+    tree.applyVisitor([&ofs](const BT::TreeNode* node) {
+        ofs << node->UID() << '\t' << node->fullPath() << '\n';
+    });
+}
+
+TraceReader::TraceReader(const std::string& path) : path_(path) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        throw std::runtime_error("TraceReader: cannot open " + path);
+    }
+
+    // Read the header field by field; it holds an atomic and is not
+    // trivially copyable as a whole
+    char magic[8];
+    uint32_t version = 0;
+    uint32_t record_size = 0;
+    uint64_t capacity = 0;
+    uint64_t write_index = 0;
+    ifs.read(magic, sizeof(magic));
+    ifs.read(reinterpret_cast<char*>(&version), sizeof(version));
+    ifs.read(reinterpret_cast<char*>(&record_size), sizeof(record_size));
+    ifs.read(reinterpret_cast<char*>(&capacity), sizeof(capacity));
+    ifs.read(reinterpret_cast<char*>(&start_ns_), sizeof(start_ns_));
+    ifs.read(reinterpret_cast<char*>(&write_index), sizeof(write_index));
+    if (!ifs ||
+        std::memcmp(magic, TraceFileHeader::kMagic, sizeof(magic)) != 0 ||
+        version != TraceFileHeader::kVersion ||
+        record_size != sizeof(TraceRecord) || capacity == 0) {
+        throw std::runtime_error("TraceReader: not a trace file " + path);
+    }
+
+    ifs.seekg(sizeof(TraceFileHeader));
+    std::vector<TraceRecord> ring(capacity);
+    ifs.read(reinterpret_cast<char*>(ring.data()),
+             static_cast<std::streamsize>(capacity * sizeof(TraceRecord)));
+
+    const uint64_t count = std::min<uint64_t>(write_index, capacity);
+    records_.reserve(count);
+    for (uint64_t i = write_index - count; i < write_index; ++i) {
+        const TraceRecord& rec = ring[i % capacity];
+        // Skip slots that were being written when the file was read
+        if (rec.seq == i + 1) {
+            records_.push_back(rec);
+        }
+    }
+}
+
+std::vector<std::string> TraceReader::NodeNames() const {
+    std::vector<std::string> names;
+    std::ifstream ifs(path_ + ".names");
+    size_t uid = 0;
+    std::string name;
+    while (ifs >> uid && ifs.get() == '\t' && std::getline(ifs, name)) {
+        if (uid >= names.size()) {
+            names.resize(uid + 1);
+        }
+        names[uid] = name;
+    }
+    return names;
+}
+
+TraceLogger::TraceLogger(const BT::Tree& tree,
+                         std::shared_ptr<TraceRecorder> recorder)
+    : StatusChangeLogger(tree.rootNode()), recorder_(std::move(recorder)) {
+    recorder_->WriteNodeNames(tree);
+}
+TraceLogger::~TraceLogger() = default;
+
+void TraceLogger::callback(BT::Duration timestamp, const BT::TreeNode& node,
+                           BT::NodeStatus prev_status, BT::NodeStatus status) {
+    recorder_->Record(node.UID(), static_cast<uint8_t>(prev_status),
+                      static_cast<uint8_t>(status));
+}
+
+}  // namespace bchtree
@@ -0,0 +1,111 @@
+#include "tree_cache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+#include <string_view>
+
+namespace bchtree {
+
+namespace {
+
+std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        throw std::runtime_error("cannot read tree file: " + path.string());
+    }
+    return {std::istreambuf_iterator<char>(ifs),
+            std::istreambuf_iterator<char>()};
+}
+
+// path="..." of every <include> element. A plain scan is enough here: a
+// false positive only adds a file to the fingerprint.
+std::vector<std::string> IncludedPaths(const std::string& xml) {
+    std::vector<std::string> paths;
+    size_t pos = 0;
+    while ((pos = xml.find("<include", pos)) != std::string::npos) {
+        const size_t end = xml.find('>', pos);
+        if (end == std::string::npos) break;
+
+        const std::string_view element(xml.data() + pos, end - pos);
+        const size_t attr = element.find("path=");
+        if (attr != std::string_view::npos && attr + 5 < element.size()) {
+            const char quote = element[attr + 5];
+            const size_t value = attr + 6;
+            const size_t close = element.find(quote, value);
+            if (close != std::string_view::npos) {
+                paths.emplace_back(element.substr(value, close - value));
+            }
+        }
+        pos = end;
+    }
+    return paths;
+}
+
+void AddFingerprint(const std::filesystem::path& path,
+                    std::set<std::string>& seen,
+                    TreeCache::Fingerprint& fingerprint) {
+    const std::string key = path.lexically_normal().string();
+    if (!seen.insert(key).second) return;
+
+    const std::string xml = ReadFile(path);
+    fingerprint.emplace_back(key, std::hash<std::string>{}(xml));
+
+    // BT resolves includes relative to the including file
+    for (const auto& include : IncludedPaths(xml)) {
+        std::filesystem::path child(include);
+        if (child.is_relative()) child = path.parent_path() / child;
+        AddFingerprint(child, seen, fingerprint);
+    }
+}
+
+}  // namespace
+
+TreeCache::Fingerprint TreeCache::FingerprintOf(const std::string& tree_path) {
+    Fingerprint fingerprint;
+    std::set<std::string> seen;
+    AddFingerprint(std::filesystem::absolute(tree_path), seen, fingerprint);
+    return fingerprint;
+}
+
+BT::Tree TreeCache::CreateTree(const std::string& tree_path,
+                               const std::string& tree_id,
+                               BT::Blackboard::Ptr blackboard) {
+    // Hashing the files is far cheaper than parsing and validating them
+    Fingerprint fingerprint = FingerprintOf(tree_path);
+
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = entries_.find(tree_path);
+        if (it != entries_.end() && it->second->fingerprint == fingerprint) {
+            entry = it->second;
+        }
+    }
+
+    if (entry) {
+        ++hits_;
+    } else {
+        ++misses_;
+        entry = std::make_shared<Entry>();
+        entry->fingerprint = std::move(fingerprint);
+        entry->factory = std::make_unique<BT::BehaviorTreeFactory>();
+        register_nodes_(*entry->factory);
+        entry->factory->registerBehaviorTreeFromFile(tree_path);
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        entries_[tree_path] = entry;
+    }
+
+    std::lock_guard<std::mutex> lock(entry->mtx);
+    return entry->factory->createTree(tree_id, std::move(blackboard));
+}
+
+void TreeCache::Clear() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    entries_.clear();
+}
+
+}  // namespace bchtree
@@ -0,0 +1,146 @@
+#include "tree_supervisor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace bchtree {
+
+namespace {
+std::string Stem(const std::string& tree_path) {
+    return std::filesystem::path(tree_path).stem().string();
+}
+
+// "<parent dir>/<stem>", used when several trees share a stem
+std::string QualifiedName(const std::string& tree_path) {
+    const std::filesystem::path path(tree_path);
+    const std::string parent = path.parent_path().filename().string();
+    return parent.empty() ? Stem(tree_path) : parent + "/" + Stem(tree_path);
+}
+}  // namespace
+
+BTRunner& TreeSupervisor::AddTree(const std::string& tree_path) {
+    // Tree names label metrics and log lines, so they must be unique
+    std::string name = Stem(tree_path);
+    std::vector<Entry*> same_stem;
+    for (const auto& other : trees_) {
+        if (Stem(other->path) == name) same_stem.push_back(other.get());
+    }
+    if (!same_stem.empty()) {
+        name = QualifiedName(tree_path);
+        for (const Entry* other : same_stem) {
+            if (QualifiedName(other->path) == name) {
+                throw std::invalid_argument(
+                    "TreeSupervisor: " + tree_path + " and " + other->path +
+                    " would share the tree name '" + name + "'");
+            }
+        }
+        for (Entry* other : same_stem) {
+            other->runner->SetTreeName(QualifiedName(other->path));
+        }
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->path = tree_path;
+    entry->runner = std::make_unique<BTRunner>(ctx_, pv_manager_);
+    entry->runner->SetTreeName(name);
+    entry->runner->SetLogger(logger_);
+    if (metrics_) {
+        // The supervisor writes the shared file; runners only record
+        entry->runner->SetMetrics(metrics_, "", "");
+    }
+    trees_.push_back(std::move(entry));
+    return *trees_.back()->runner;
+}
+
+void TreeSupervisor::SetLogger(std::shared_ptr<Logger> logger) {
+    logger_ = std::move(logger);
+}
+
+void TreeSupervisor::SetThreadCount(size_t count) { thread_count_ = count; }
+
+void TreeSupervisor::SetMetrics(std::shared_ptr<Metrics> metrics,
+                                std::string path, std::string format) {
+    metrics_ = std::move(metrics);
+    metrics_path_ = std::move(path);
+    metrics_format_ = std::move(format);
+}
+
+bool TreeSupervisor::RunAll(std::chrono::milliseconds sleep_time) {
+    if (trees_.empty()) return false;
+
+    const size_t workers = (thread_count_ == 0)
+                               ? trees_.size()
+                               : std::min(thread_count_, trees_.size());
+
+    std::atomic<size_t> next{0};
+    std::mutex done_mtx;
+    std::condition_variable done_cv;
+    size_t done = 0;
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (size_t w = 0; w < workers; ++w) {
+        threads.emplace_back([&] {
+            for (size_t i = next++; i < trees_.size(); i = next++) {
+                RunEntry(*trees_[i], sleep_time);
+                std::lock_guard<std::mutex> lock(done_mtx);
+                ++done;
+                done_cv.notify_one();
+            }
+        });
+    }
+
+    // Serve metrics dump requests while the trees run
+    {
+        std::unique_lock<std::mutex> lock(done_mtx);
+        while (!done_cv.wait_for(lock, std::chrono::milliseconds(100), [&] {
+            return done == trees_.size();
+        })) {
+            if (metrics_ && metrics_->ConsumeDumpRequest()) DumpMetrics();
+        }
+    }
+
+    for (auto& t : threads) t.join();
+    DumpMetrics();
+
+    return std::all_of(trees_.begin(), trees_.end(),
+                       [](const auto& entry) { return entry->success; });
+}
+
+std::vector<std::string> TreeSupervisor::FailedTrees() const {
+    std::vector<std::string> failed;
+    for (const auto& entry : trees_) {
+        if (!entry->success) failed.push_back(entry->path);
+    }
+    return failed;
+}
+
+void TreeSupervisor::RunEntry(Entry& entry,
+                              std::chrono::milliseconds sleep_time) {
+    try {
+        entry.runner->RegisterTreeFromFile(entry.path);
+        entry.success = entry.runner->Run(sleep_time);
+    } catch (const std::exception& e) {
+        // One broken tree must not take down the others
+        if (logger_) {
+            logger_->error("TreeSupervisor: " + entry.path + ": " + e.what());
+        }
+        entry.success = false;
+    }
+}
+
+void TreeSupervisor::DumpMetrics() {
+    if (!metrics_ || metrics_path_.empty()) return;
+
+    if (!metrics_->WriteFile(metrics_path_, metrics_format_) && logger_) {
+        logger_->error("TreeSupervisor: failed to write metrics to " +
+                       metrics_path_);
+    }
+}
+
+}  // namespace bchtree
@@ -7,6 +7,7 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "actions/caget_node.h"
 #include "epics/ca/ca_pv.h"
@@ -32,6 +33,8 @@ class CAGetNodeFactoryHelper {
                                                    pv_manager_);
         factory_->registerNodeType<CAGetNode<std::string>>("CAGetString", ctx_,
                                                            pv_manager_);
+        factory_->registerNodeType<CAGetNode<std::vector<double>>>(
+            "CAGetDoubleArray", ctx_, pv_manager_);
     }
 
     // Build a single-node tree from XML, run until it finishes, and return
@@ -57,6 +60,14 @@ class CAGetNodeFactoryHelper {
         return status;  // Caller decides if it stays RUNNING
     }
 
+    // Runs a single node given as an XML element
+    BT::NodeStatus runNode(const std::string& node_xml) {
+        return helper_->runSingle(
+            R"(<root BTCPP_format="4"><BehaviorTree ID="MainTree">)" +
+                node_xml + R"(</BehaviorTree></root>)",
+            std::chrono::milliseconds(3000), std::chrono::milliseconds(20));
+    }
+
     template <typename T>
     bool getFromBB(const std::string& result_key, T& out) const {
         return helper_->getFromBB(result_key, out);
@@ -115,6 +126,24 @@ TEST_F(SoftIocFixture, CAGetNode_GetString_FactoryHelper) {
     EXPECT_EQ(got, "Hello");
 }
 
+// Get std::vector<double> from TEST:WF with use_monitor=false
+TEST_F(SoftIocFixture, CAGetNode_GetDoubleArray_FactoryHelper) {
+    ASSERT_EQ(system("caput -a TEST:WF 3 1.5 2.5 3.5"), 0);
+    CAGetNodeFactoryHelper helper(ctx_);
+
+    const std::string key = "out";
+    auto status =
+        helper.runSingle("CAGetDoubleArray", "TEST:WF", 2000, false, key);
+    ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+
+    std::vector<double> got;
+    ASSERT_TRUE(helper.getFromBB<std::vector<double>>(key, got));
+    ASSERT_GE(got.size(), 3u);
+    EXPECT_DOUBLE_EQ(got[0], 1.5);
+    EXPECT_DOUBLE_EQ(got[1], 2.5);
+    EXPECT_DOUBLE_EQ(got[2], 3.5);
+}
+
 // use_monitor=true path (TEST:AO)
 TEST_F(SoftIocFixture, CAGetNode_UseMonitor_FactoryHelper) {
     ASSERT_EQ(system("caput -t TEST:AO 7.5"), 0);
@@ -130,6 +159,46 @@ TEST_F(SoftIocFixture, CAGetNode_UseMonitor_FactoryHelper) {
     EXPECT_NEAR(got, 7.5, 1e-6);
 }
 
+// Enum PV read as string gives the state string (get and monitor paths)
+TEST_F(SoftIocFixture, CAGetNode_EnumAsString_FactoryHelper) {
+    ASSERT_EQ(system("caput -t TEST:BO 1"), 0);
+    CAGetNodeFactoryHelper helper(ctx_);
+
+    for (bool use_monitor : {false, true}) {
+        const std::string key = "out";
+        auto status = helper.runSingle("CAGetString", "TEST:BO", 2000,
+                                       use_monitor, key);
+        ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+
+        std::string got;
+        ASSERT_TRUE(helper.getFromBB<std::string>(key, got));
+        EXPECT_EQ(got, "On");
+    }
+}
+
+// Property outputs come from the channel's cached DBR_CTRL_* info
+TEST_F(SoftIocFixture, CAGetNode_ControlInfoPorts_FactoryHelper) {
+    CAGetNodeFactoryHelper helper(ctx_);
+
+    auto status = helper.runNode(
+        R"(<CAGetDouble pv="TEST:AOLIM" timeout="2000" result="{out}" )"
+        R"(units="{units}" precision="{prec}" ctrl_low="{lo}" )"
+        R"(ctrl_high="{hi}"/>)");
+    ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+
+    std::string units;
+    int prec{};
+    double lo{}, hi{};
+    ASSERT_TRUE(helper.getFromBB<std::string>("units", units));
+    ASSERT_TRUE(helper.getFromBB<int>("prec", prec));
+    ASSERT_TRUE(helper.getFromBB<double>("lo", lo));
+    ASSERT_TRUE(helper.getFromBB<double>("hi", hi));
+    EXPECT_EQ(units, "mm");
+    EXPECT_EQ(prec, 3);
+    EXPECT_DOUBLE_EQ(lo, -10.0);
+    EXPECT_DOUBLE_EQ(hi, 10.0);
+}
+
 // Non-existent PV → timeout leads to FAILURE
 TEST_F(SoftIocFixture, CAGetNode_Timeout_FactoryHelper) {
     CAGetNodeFactoryHelper helper(ctx_);
@@ -141,3 +210,16 @@ TEST_F(SoftIocFixture, CAGetNode_Timeout_FactoryHelper) {
                                    std::chrono::milliseconds(2000));
     ASSERT_EQ(status, BT::NodeStatus::FAILURE);
 }
+
+// A reply that cannot be converted fails the node at once, with the reason
+TEST_F(SoftIocFixture, CAGetNode_ConversionError_FailsBeforeTimeout) {
+    ASSERT_EQ(system("caput -t TEST:STRO Hello"), 0);
+    CAGetNodeFactoryHelper helper(ctx_);
+
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(helper.runSingle("CAGetDouble", "TEST:STRO", 2000,
+                                  /*use_monitor*/ false, "out"),
+                 BT::RuntimeError);
+    EXPECT_LT(std::chrono::steady_clock::now() - start,
+              std::chrono::milliseconds(1500));
+}
@@ -0,0 +1,101 @@
+#include <behaviortree_cpp/bt_factory.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "actions/camulti_node.h"
+#include "epics/ca/ca_pv_manager.h"
+#include "epics/ca/pv_group.h"
+#include "node_test_helper.h"
+#include "softioc_fixture.h"
+
+using namespace bchtree;
+using namespace bchtree::epics::ca;
+
+class CAMultiNodeFactoryHelper {
+   public:
+    CAMultiNodeFactoryHelper(std::shared_ptr<CAContextManager> ctx)
+        : ctx_(std::move(ctx)) {
+        pv_manager_ = std::make_shared<PVManager>(ctx_);
+        factory_ = std::make_shared<BT::BehaviorTreeFactory>();
+        helper_ = std::make_unique<NodeTestHelper>(factory_);
+
+        factory_->registerNodeType<CAGetMultiNode<double>>(
+            "CAGetMultiDouble", ctx_, pv_manager_);
+        factory_->registerNodeType<CAPutMultiNode<double>>(
+            "CAPutMultiDouble", ctx_, pv_manager_);
+    }
+
+    BT::NodeStatus runSingle(const std::string& node) {
+        const std::string xml =
+            R"(<root BTCPP_format="4"><BehaviorTree ID="MainTree">)" + node +
+            R"(</BehaviorTree></root>)";
+        return helper_->runSingle(xml, std::chrono::milliseconds(3000),
+                                  std::chrono::milliseconds(20));
+    }
+
+    template <typename T>
+    bool getFromBB(const std::string& key, T& out) const {
+        return helper_->getFromBB(key, out);
+    }
+
+   private:
+    std::shared_ptr<CAContextManager> ctx_;
+    std::shared_ptr<PVManager> pv_manager_;
+    std::shared_ptr<BT::BehaviorTreeFactory> factory_;
+    std::unique_ptr<NodeTestHelper> helper_;
+};
+
+TEST(PVGroupTest, ExpandPattern) {
+    EXPECT_EQ(PVGroup::ExpandPattern("MAG:PS{}:CUR", "1..3"),
+              (std::vector<std::string>{"MAG:PS1:CUR", "MAG:PS2:CUR",
+                                        "MAG:PS3:CUR"}));
+    EXPECT_EQ(PVGroup::ExpandPattern("BPM{}", "09..11"),
+              (std::vector<std::string>{"BPM09", "BPM10", "BPM11"}));
+    EXPECT_THROW(PVGroup::ExpandPattern("NOSLOT", "1..3"),
+                 std::invalid_argument);
+    EXPECT_THROW(PVGroup::ExpandPattern("X{}", "3..1"), std::invalid_argument);
+}
+
+TEST_F(SoftIocFixture, CAMultiNode_GetInPVOrder) {
+    ASSERT_EQ(system("caput -t TEST:AO 1.25"), 0);
+    ASSERT_EQ(system("caput -t TEST:LO 9"), 0);
+    CAMultiNodeFactoryHelper helper(ctx_);
+
+    auto status = helper.runSingle(
+        R"(<CAGetMultiDouble pvs="TEST:LO;TEST:AO" timeout="2000" )"
+        R"(result="{out}"/>)");
+    ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+
+    std::vector<double> got;
+    ASSERT_TRUE(helper.getFromBB("out", got));
+    EXPECT_EQ(got, (std::vector<double>{9.0, 1.25}));
+}
+
+TEST_F(SoftIocFixture, CAMultiNode_PutBroadcastThenGet) {
+    CAMultiNodeFactoryHelper helper(ctx_);
+
+    ASSERT_EQ(helper.runSingle(R"(<CAPutMultiDouble pvs="TEST:AO;TEST:LO" )"
+                               R"(values="4" timeout="2000"/>)"),
+              BT::NodeStatus::SUCCESS);
+    ASSERT_EQ(helper.runSingle(R"(<CAGetMultiDouble pvs="TEST:AO;TEST:LO" )"
+                               R"(timeout="2000" result="{out}"/>)"),
+              BT::NodeStatus::SUCCESS);
+
+    std::vector<double> got;
+    ASSERT_TRUE(helper.getFromBB("out", got));
+    EXPECT_EQ(got, (std::vector<double>{4.0, 4.0}));
+}
+
+TEST_F(SoftIocFixture, CAMultiNode_TimesOutOnMissingPV) {
+    CAMultiNodeFactoryHelper helper(ctx_);
+
+    auto status = helper.runSingle(
+        R"(<CAGetMultiDouble pvs="TEST:AO;TEST:NOPE" timeout="200" )"
+        R"(result="{out}"/>)");
+    EXPECT_EQ(status, BT::NodeStatus::FAILURE);
+}
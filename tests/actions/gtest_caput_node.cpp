@@ -94,6 +94,14 @@ class CAPutNodeFactoryHelper {
         return helper_->runOnce(xml.str());
     }
 
+    // Runs a single node given as an XML element
+    BT::NodeStatus runNode(const std::string& node_xml) {
+        return helper_->runSingle(
+            R"(<root BTCPP_format="4"><BehaviorTree ID="MainTree">)" +
+                node_xml + R"(</BehaviorTree></root>)",
+            std::chrono::milliseconds(3000), std::chrono::milliseconds(20));
+    }
+
     std::shared_ptr<PVManager> GetPVManager() { return pv_manager_; }
 
    private:
@@ -216,6 +224,31 @@ TEST_F(SoftIocFixture, CAPut_ForceWrite_True_Performs_Put_Even_If_SameValue) {
     EXPECT_EQ(got, target);
 }
 
+TEST_F(SoftIocFixture, CAPut_CheckLimits_Rejects_OutOfRange) {
+    CAPutNodeFactoryHelper helper(ctx_);
+
+    // TEST:AOLIM has DRVL=-10, DRVH=10
+    EXPECT_EQ(helper.runNode(R"(<CAPutDouble pv="TEST:AOLIM" value="4.5" )"
+                             R"(timeout="1500" check_limits="true"/>)"),
+              BT::NodeStatus::SUCCESS);
+    EXPECT_EQ(helper.runNode(R"(<CAPutDouble pv="TEST:AOLIM" value="50" )"
+                             R"(timeout="1500" check_limits="true"/>)"),
+              BT::NodeStatus::FAILURE);
+
+    // The rejected value was never written
+    std::optional<double> got = ReadPV<double>(ctx_, "TEST:AOLIM");
+    ASSERT_TRUE(got.has_value());
+    EXPECT_NEAR(*got, 4.5, 1e-6);
+
+    // Strings written to an enum PV must name a state
+    EXPECT_EQ(helper.runNode(R"(<CAPutString pv="TEST:BO" value="Maybe" )"
+                             R"(timeout="1500" check_limits="true"/>)"),
+              BT::NodeStatus::FAILURE);
+    EXPECT_EQ(helper.runNode(R"(<CAPutString pv="TEST:BO" value="On" )"
+                             R"(timeout="1500" check_limits="true"/>)"),
+              BT::NodeStatus::SUCCESS);
+}
+
 TEST_F(SoftIocFixture, CAPut_Respects_CustomTimeout) {
     // Very small timeout to force a quick failure on a PV that won't exist.
     CAPutNodeFactoryHelper helper(ctx_);
@@ -0,0 +1,114 @@
+#include <behaviortree_cpp/bt_factory.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "actions/caput_verify_node.h"
+#include "epics/ca/ca_pv_manager.h"
+#include "node_test_helper.h"
+#include "softioc_fixture.h"
+
+using namespace bchtree;
+using namespace bchtree::epics::ca;
+
+class CAPutVerifyNodeFactoryHelper {
+   public:
+    CAPutVerifyNodeFactoryHelper(std::shared_ptr<CAContextManager> ctx)
+        : ctx_(std::move(ctx)) {
+        pv_manager_ = std::make_shared<PVManager>(ctx_);
+        factory_ = std::make_shared<BT::BehaviorTreeFactory>();
+        helper_ = std::make_unique<NodeTestHelper>(factory_);
+
+        factory_->registerNodeType<CAPutVerifyNode<double>>(
+            "CAPutVerifyDouble", ctx_, pv_manager_);
+        factory_->registerNodeType<CAPutVerifyNode<int>>("CAPutVerifyInt",
+                                                         ctx_, pv_manager_);
+    }
+
+    // attrs: node attributes, e.g. pv="TEST:SP" readback="TEST:RBV"
+    BT::NodeStatus runSingle(const std::string& node_tag,
+                             const std::string& attrs,
+                             std::chrono::milliseconds overall_timeout =
+                                 std::chrono::milliseconds(3000)) {
+        const std::string xml =
+            R"(<root BTCPP_format="4"><BehaviorTree ID="MainTree">)" "<" +
+            node_tag + " " + attrs + R"( result="{out}"/>)" +
+            R"(</BehaviorTree></root>)";
+        return helper_->runSingle(xml, overall_timeout,
+                                  std::chrono::milliseconds(20));
+    }
+
+    template <typename T>
+    bool getFromBB(const std::string& key, T& out) const {
+        return helper_->getFromBB(key, out);
+    }
+
+   private:
+    std::shared_ptr<CAContextManager> ctx_;
+    std::shared_ptr<PVManager> pv_manager_;
+    std::shared_ptr<BT::BehaviorTreeFactory> factory_;
+    std::unique_ptr<NodeTestHelper> helper_;
+};
+
+// TEST:RBV follows TEST:SP on its next scan, then has to hold
+TEST_F(SoftIocFixture, CAPutVerifyNode_ConvergesAndSettles) {
+    ASSERT_EQ(system("caput -t TEST:SP 0"), 0);
+    CAPutVerifyNodeFactoryHelper helper(ctx_);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto status = helper.runSingle(
+        "CAPutVerifyDouble",
+        R"(pv="TEST:SP" readback="TEST:RBV" value="3.5" tolerance="0.01" )"
+        R"(settle="200" timeout="2000")");
+    ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+    EXPECT_GE(std::chrono::steady_clock::now() - start,
+              std::chrono::milliseconds(200));
+
+    double got{};
+    ASSERT_TRUE(helper.getFromBB<double>("out", got));
+    EXPECT_NEAR(got, 3.5, 0.01);
+}
+
+// The put succeeds but the readback never gets there
+TEST_F(SoftIocFixture, CAPutVerifyNode_TimesOut) {
+    ASSERT_EQ(system("caput -t TEST:LO 0"), 0);
+    CAPutVerifyNodeFactoryHelper helper(ctx_);
+
+    auto status = helper.runSingle(
+        "CAPutVerifyDouble",
+        R"(pv="TEST:SP" readback="TEST:LO" value="1" timeout="300")");
+    EXPECT_EQ(status, BT::NodeStatus::FAILURE);
+}
+
+// Without a readback port the written PV itself is verified
+TEST_F(SoftIocFixture, CAPutVerifyNode_ReadbackDefaultsToPv) {
+    ASSERT_EQ(system("caput -t TEST:LO 0"), 0);
+    CAPutVerifyNodeFactoryHelper helper(ctx_);
+
+    auto status = helper.runSingle(
+        "CAPutVerifyInt", R"(pv="TEST:LO" value="42" timeout="2000")");
+    ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+
+    int got{};
+    ASSERT_TRUE(helper.getFromBB<int>("out", got));
+    EXPECT_EQ(got, 42);
+
+    // The IOC is shared by the suite; other tests expect TEST:LO at 0
+    ASSERT_EQ(system("caput -t TEST:LO 0"), 0);
+}
+
+// Writing the current value posts no monitor update; the readback get
+// issued at put completion confirms it
+TEST_F(SoftIocFixture, CAPutVerifyNode_UnchangedValueSucceeds) {
+    ASSERT_EQ(system("caput -t TEST:LO 7"), 0);
+    CAPutVerifyNodeFactoryHelper helper(ctx_);
+
+    auto status = helper.runSingle(
+        "CAPutVerifyInt", R"(pv="TEST:LO" value="7" timeout="2000")");
+    EXPECT_EQ(status, BT::NodeStatus::SUCCESS);
+
+    ASSERT_EQ(system("caput -t TEST:LO 0"), 0);
+}
@@ -0,0 +1,113 @@
+#include <behaviortree_cpp/bt_factory.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "actions/cawait_node.h"
+#include "epics/ca/ca_pv_manager.h"
+#include "node_test_helper.h"
+#include "softioc_fixture.h"
+
+using namespace bchtree;
+using namespace bchtree::epics::ca;
+
+class CAWaitNodeFactoryHelper {
+   public:
+    CAWaitNodeFactoryHelper(std::shared_ptr<CAContextManager> ctx)
+        : ctx_(std::move(ctx)) {
+        pv_manager_ = std::make_shared<PVManager>(ctx_);
+        factory_ = std::make_shared<BT::BehaviorTreeFactory>();
+        helper_ = std::make_unique<NodeTestHelper>(factory_);
+
+        factory_->registerNodeType<CAWaitNode<double>>("CAWaitDouble", ctx_,
+                                                       pv_manager_);
+        factory_->registerNodeType<CAWaitNode<int>>("CAWaitInt", ctx_,
+                                                    pv_manager_);
+    }
+
+    // attrs: node attributes, e.g. pv="TEST:AO" op="gt" value="1"
+    BT::NodeStatus runSingle(const std::string& node_tag,
+                             const std::string& attrs,
+                             std::chrono::milliseconds overall_timeout =
+                                 std::chrono::milliseconds(3000)) {
+        const std::string xml =
+            R"(<root BTCPP_format="4"><BehaviorTree ID="MainTree">)" "<" +
+            node_tag + " " + attrs + R"( result="{out}"/>)" +
+            R"(</BehaviorTree></root>)";
+        return helper_->runSingle(xml, overall_timeout,
+                                  std::chrono::milliseconds(20));
+    }
+
+    template <typename T>
+    bool getFromBB(const std::string& key, T& out) const {
+        return helper_->getFromBB(key, out);
+    }
+
+   private:
+    std::shared_ptr<CAContextManager> ctx_;
+    std::shared_ptr<PVManager> pv_manager_;
+    std::shared_ptr<BT::BehaviorTreeFactory> factory_;
+    std::unique_ptr<NodeTestHelper> helper_;
+};
+
+// Condition already true when the node starts
+TEST_F(SoftIocFixture, CAWaitNode_AlreadySatisfied) {
+    ASSERT_EQ(system("caput -t TEST:AO 5"), 0);
+    CAWaitNodeFactoryHelper helper(ctx_);
+
+    auto status = helper.runSingle(
+        "CAWaitDouble", R"(pv="TEST:AO" op="eq" value="5" timeout="2000")");
+    ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+
+    double got{};
+    ASSERT_TRUE(helper.getFromBB<double>("out", got));
+    EXPECT_DOUBLE_EQ(got, 5.0);
+}
+
+// Condition becomes true while waiting; delivered by the monitor
+TEST_F(SoftIocFixture, CAWaitNode_SatisfiedByMonitorUpdate) {
+    ASSERT_EQ(system("caput -t TEST:AO 0"), 0);
+    CAWaitNodeFactoryHelper helper(ctx_);
+
+    std::thread writer([] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        system("caput -t TEST:AO 7.02");
+    });
+    auto status = helper.runSingle(
+        "CAWaitDouble",
+        R"(pv="TEST:AO" op="within" value="7" tolerance="0.05" )"
+        R"(timeout="2500")");
+    writer.join();
+    ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+
+    double got{};
+    ASSERT_TRUE(helper.getFromBB<double>("out", got));
+    EXPECT_NEAR(got, 7.02, 1e-9);
+}
+
+TEST_F(SoftIocFixture, CAWaitNode_TimesOut) {
+    ASSERT_EQ(system("caput -t TEST:AO 1"), 0);
+    CAWaitNodeFactoryHelper helper(ctx_);
+
+    auto status = helper.runSingle(
+        "CAWaitDouble", R"(pv="TEST:AO" op="gt" value="100" timeout="200")");
+    EXPECT_EQ(status, BT::NodeStatus::FAILURE);
+}
+
+TEST_F(SoftIocFixture, CAWaitNode_BitmaskWithStableTime) {
+    ASSERT_EQ(system("caput -t TEST:LO 6"), 0);
+    CAWaitNodeFactoryHelper helper(ctx_);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto status = helper.runSingle(
+        "CAWaitInt",
+        R"(pv="TEST:LO" op="mask" mask="2" value="2" stable="200" )"
+        R"(timeout="2000")");
+    ASSERT_EQ(status, BT::NodeStatus::SUCCESS);
+    EXPECT_GE(std::chrono::steady_clock::now() - start,
+              std::chrono::milliseconds(200));
+}
@@ -2,10 +2,12 @@
 #include <db_access.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <future>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
@@ -72,6 +74,61 @@ TEST_F(SoftIocFixture, CAPV_PutCB_Double) {
     EXPECT_NEAR(rd, 12.3, 1e-3);
 }
 
+TEST_F(SoftIocFixture, CAPV_MonitorCB_CalledOnUpdate) {
+    CAPV pv(ctx_, "TEST:AO");
+
+    std::promise<void> first;
+    std::atomic<bool> fired{false};
+    pv.AddMonitorCB([&]() {
+        if (!fired.exchange(true)) first.set_value();
+    });
+
+    pv.Connect();
+    ASSERT_TRUE(WaitUntilConnected(pv));
+
+    // Initial monitor update arrives after connection
+    ASSERT_EQ(first.get_future().wait_for(4s), std::future_status::ready)
+        << "No monitor event";
+    EXPECT_TRUE(pv.HasValue());
+    EXPECT_GE(pv.ValueUpdates(), 1u);
+}
+
+TEST_F(SoftIocFixture, CAPV_Snapshot_IsStableAcrossUpdates) {
+    CAPV pv(ctx_, "TEST:AO");
+
+    std::atomic<int> updates{0};
+    pv.AddMonitorCB([&]() { ++updates; });
+
+    pv.Connect();
+    ASSERT_TRUE(WaitUntilConnected(pv));
+
+    std::promise<bool> put1;
+    pv.PutCB(1.0, [&](bool success) { put1.set_value(success); });
+    ASSERT_EQ(put1.get_future().wait_for(4s), std::future_status::ready);
+
+    // Wait for the monitor to reflect the put
+    const auto deadline = std::chrono::steady_clock::now() + 4s;
+    while (pv.GetAs<double>() != 1.0 &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(10ms);
+    }
+    auto held = pv.Snapshot();
+    ASSERT_EQ(held->As<double>(), 1.0);
+
+    const int before = updates;
+    std::promise<bool> put2;
+    pv.PutCB(2.0, [&](bool success) { put2.set_value(success); });
+    ASSERT_EQ(put2.get_future().wait_for(4s), std::future_status::ready);
+    while (updates == before && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(10ms);
+    }
+
+    // The held snapshot is immutable; new readers see the new value
+    EXPECT_EQ(held->As<double>(), 1.0);
+    EXPECT_NE(pv.Snapshot().get(), held.get());
+    EXPECT_NEAR(pv.GetAs<double>(), 2.0, 1e-9);
+}
+
 // ---------- Put and Get tests with PutCB and GetAs ----------
 template <class T>
 struct PutInput;
@@ -154,6 +211,195 @@ TYPED_TEST(PutCB_Typed, CAPV_PutCB_and_GetAs_GetCBAs) {
     EXPECT_EQ(got_cb_value, value);
 }
 
+TEST_F(SoftIocFixture, CAPV_PutCB_and_GetAs_Array) {
+    CAPV pv(ctx_, "TEST:WF");
+    pv.Connect();
+    ASSERT_TRUE(WaitUntilConnected(pv));
+
+    std::vector<double> value(16);
+    for (size_t i = 0; i < value.size(); ++i) value[i] = 0.5 * i;
+
+    std::promise<bool> done;
+    auto fut = done.get_future();
+    bool enq = pv.PutCB(bchtree::epics::PVArrayValue{value},
+                        [&](bool success) { done.set_value(success); });
+    ASSERT_TRUE(enq) << "ca_array_put_callback enqueue failed";
+    ASSERT_EQ(fut.wait_for(4s), std::future_status::ready);
+    EXPECT_TRUE(fut.get());
+
+    std::promise<std::vector<double>> got_cb;
+    pv.GetCBAs<std::vector<double>>(
+        [&](std::vector<double> v) { got_cb.set_value(std::move(v)); },
+        std::chrono::milliseconds(1000));
+    auto got_fut = got_cb.get_future();
+    ASSERT_EQ(got_fut.wait_for(4s), std::future_status::ready);
+    EXPECT_EQ(got_fut.get(), value);
+
+    // Numeric array cast and first-element scalar access
+    auto as_int = pv.GetAs<std::vector<int32_t>>();
+    ASSERT_EQ(as_int.size(), value.size());
+    EXPECT_EQ(as_int[4], 2);
+    EXPECT_DOUBLE_EQ(pv.GetAs<double>(), 0.0);
+}
+
+TEST_F(SoftIocFixture, CAPV_GetCBAs_Batched_CompletesAfterBatchEnds) {
+    std::vector<std::unique_ptr<CAPV>> pvs;
+    for (const char* name : {"TEST:AO", "TEST:LO", "TEST:STRO"}) {
+        pvs.push_back(std::make_unique<CAPV>(ctx_, name));
+        pvs.back()->Connect();
+        ASSERT_TRUE(WaitUntilConnected(*pvs.back()));
+    }
+
+    // Two gets per channel, all answered after one flush
+    constexpr size_t kGetsPerPV = 2;
+    std::vector<std::promise<void>> done(pvs.size() * kGetsPerPV);
+    const uint64_t flushes_before = ctx_->FlushCount();
+    {
+        bchtree::epics::ca::IOBatch batch(*ctx_);
+        for (size_t i = 0; i < done.size(); ++i) {
+            ASSERT_TRUE(pvs[i % pvs.size()]->GetCBAs<bchtree::epics::PVData>(
+                [&, i](bchtree::epics::PVData) { done[i].set_value(); },
+                std::chrono::milliseconds(1000)));
+        }
+        EXPECT_EQ(ctx_->FlushCount(), flushes_before)
+            << "Requests were flushed inside the batch";
+    }  // single flush here
+
+    const uint64_t flushes = ctx_->FlushCount() - flushes_before;
+    EXPECT_GE(flushes, 1u);
+    EXPECT_LT(flushes, done.size());
+
+    for (auto& d : done) {
+        ASSERT_EQ(d.get_future().wait_for(4s), std::future_status::ready)
+            << "No get callback event after batch flush";
+    }
+}
+
+TEST_F(SoftIocFixture, CAPV_GetCBAs_ReusesPooledRequests) {
+    using bchtree::epics::ca::GetCBCtxAs;
+    using bchtree::epics::ca::RequestPool;
+    auto& pool = RequestPool<GetCBCtxAs<double>>::Instance();
+
+    CAPV pv(ctx_, "TEST:AO");
+    pv.Connect();
+    ASSERT_TRUE(WaitUntilConnected(pv));
+
+    auto get_once = [&]() {
+        std::promise<void> got;
+        auto fut = got.get_future();
+        ASSERT_TRUE(pv.GetCBAs<double>([&](double) { got.set_value(); },
+                                       std::chrono::milliseconds(1000)));
+        ASSERT_EQ(fut.wait_for(4s), std::future_status::ready);
+    };
+
+    get_once();
+    const size_t warm = pool.Capacity();
+    for (int i = 0; i < 500; ++i) get_once();
+
+    // Sequential requests recycle the same slots; each is back in the pool
+    // before its callback runs
+    EXPECT_EQ(pool.Capacity(), warm);
+    EXPECT_EQ(pool.InFlight(), 0u);
+}
+
+TEST(MonitorPolicyTest, ParseAndMerge) {
+    using bchtree::epics::ca::MonitorPolicy;
+
+    const auto lazy = MonitorPolicy::Parse("lazy,log,100ms");
+    EXPECT_EQ(lazy.mode, MonitorPolicy::Mode::kLazy);
+    EXPECT_EQ(lazy.mask, static_cast<unsigned long>(DBE_LOG | DBE_ALARM));
+    EXPECT_EQ(lazy.min_interval, std::chrono::milliseconds(100));
+    EXPECT_EQ(MonitorPolicy::Parse("").mode, MonitorPolicy::Mode::kOn);
+    EXPECT_THROW(MonitorPolicy::Parse("fast"), std::invalid_argument);
+
+    // Merging never narrows what another user of the channel needs
+    const auto merged = lazy.Merge(MonitorPolicy::Parse("value"));
+    EXPECT_EQ(merged.mode, MonitorPolicy::Mode::kOn);
+    EXPECT_EQ(merged.mask,
+              static_cast<unsigned long>(DBE_VALUE | DBE_LOG | DBE_ALARM));
+    EXPECT_EQ(merged.min_interval, std::chrono::milliseconds(0));
+    EXPECT_EQ(lazy.Merge(MonitorPolicy::Parse("off")).mode,
+              MonitorPolicy::Mode::kLazy);
+
+    // An interval stol cannot hold is a usage error, not out_of_range
+    EXPECT_THROW(MonitorPolicy::Parse("99999999999999999999ms"),
+                 std::invalid_argument);
+    EXPECT_EQ(lazy.ToString(), "lazy,log,100ms");
+    EXPECT_TRUE(MonitorPolicy::Parse(lazy.ToString()) == lazy);
+}
+
+// A user's policy replaces the manager default instead of being widened by
+// it; only policies set by users are merged
+TEST_F(SoftIocFixture, CAPV_MonitorPolicy_ReplacesDefault) {
+    using bchtree::epics::ca::MonitorPolicy;
+    CAPV pv(ctx_, "TEST:AO", MonitorPolicy::Parse("on"));
+
+    pv.ApplyMonitorPolicy(MonitorPolicy::Parse("log,100ms"));
+    auto policy = pv.GetMonitorPolicy();
+    EXPECT_EQ(policy.mask, static_cast<unsigned long>(DBE_LOG | DBE_ALARM));
+    EXPECT_EQ(policy.min_interval, std::chrono::milliseconds(100));
+
+    pv.ApplyMonitorPolicy(MonitorPolicy::Parse("value,200ms"));
+    policy = pv.GetMonitorPolicy();
+    EXPECT_EQ(policy.mask,
+              static_cast<unsigned long>(DBE_VALUE | DBE_LOG | DBE_ALARM));
+    EXPECT_EQ(policy.min_interval, std::chrono::milliseconds(100));
+
+    CAPV off(ctx_, "TEST:LO", MonitorPolicy::Parse("on"));
+    off.ApplyMonitorPolicy(MonitorPolicy::Parse("off"));
+    EXPECT_FALSE(off.RequestMonitor());
+}
+
+TEST_F(SoftIocFixture, CAPV_LazyMonitor_StartsOnRequest) {
+    using bchtree::epics::ca::MonitorPolicy;
+    CAPV pv(ctx_, "TEST:AO", MonitorPolicy::Parse("lazy"));
+    pv.Connect();
+    ASSERT_TRUE(WaitUntilConnected(pv));
+
+    std::this_thread::sleep_for(200ms);
+    EXPECT_FALSE(pv.HasValue()) << "lazy channel subscribed on connect";
+
+    ASSERT_TRUE(pv.RequestMonitor());
+    const auto deadline = std::chrono::steady_clock::now() + 4s;
+    while (!pv.HasValue() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(10ms);
+    }
+    EXPECT_TRUE(pv.HasValue());
+
+    CAPV off(ctx_, "TEST:LO", MonitorPolicy::Parse("off"));
+    EXPECT_FALSE(off.RequestMonitor());
+}
+
+TEST_F(SoftIocFixture, CAPV_MonitorMinInterval_CoalescesUpdates) {
+    using bchtree::epics::ca::MonitorPolicy;
+    CAPV pv(ctx_, "TEST:AO", MonitorPolicy::Parse("500ms"));
+
+    std::atomic<int> calls{0};
+    std::atomic<double> last_seen{0.0};
+    pv.AddMonitorCB([&]() {
+        ++calls;
+        last_seen = pv.GetAs<double>();
+    });
+    pv.Connect();
+    ASSERT_TRUE(WaitUntilConnected(pv));
+    const auto first = std::chrono::steady_clock::now() + 4s;
+    while (calls == 0 && std::chrono::steady_clock::now() < first) {
+        std::this_thread::sleep_for(10ms);
+    }
+    ASSERT_EQ(calls, 1);
+
+    // Several updates inside one interval: one trailing notification
+    for (int i = 1; i <= 5; ++i) {
+        std::promise<bool> put;
+        pv.PutCB(100.0 + i, [&](bool success) { put.set_value(success); });
+        ASSERT_EQ(put.get_future().wait_for(4s), std::future_status::ready);
+    }
+    std::this_thread::sleep_for(1s);
+
+    EXPECT_EQ(calls, 2);
+    EXPECT_DOUBLE_EQ(last_seen, 105.0);
+}
+
 TEST_F(SoftIocFixture, CAPV_Disconnect_Reconnect) {
     CAPV pv(ctx_, "TEST:AO");
     std::vector<bool> states;
@@ -1,11 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
 #include "epics/ca/ca_pv_manager.h"
+#include "helper_func.h"
+#include "softioc_fixture.h"
 
 using namespace bchtree::epics::ca;
 
@@ -106,3 +110,110 @@ TEST_F(PVManagerTest, DifferentNamesAreDifferentInstances) {
     EXPECT_NE(a.get(), b.get());
     EXPECT_EQ(manager_->RegistrySize(), 2u);
 }
+
+TEST(PVManagerLookupTest, StringViewAndPrehashedLookupShareInstance) {
+    PVManager manager(std::make_shared<CAContextManager>());
+
+    const std::string name = "TEST:PV9";
+    auto by_string = manager.Get(name);
+    auto by_view = manager.Get(std::string_view(name));
+    auto by_hash = manager.Get(name, PVManager::Hash(name));
+
+    EXPECT_EQ(by_string.get(), by_view.get());
+    EXPECT_EQ(by_string.get(), by_hash.get());
+    EXPECT_EQ(manager.RegistrySize(), 1u);
+}
+
+TEST(PVManagerLingerTest, ReleasedChannelIsReused) {
+    PVManager manager(std::make_shared<CAContextManager>());
+    manager.SetLingerPolicy({4, std::chrono::minutes(1)});
+
+    CAPV* first = nullptr;
+    {
+        auto pv = manager.Get("TEST:LINGER1");
+        first = pv.get();
+    }
+    EXPECT_EQ(manager.Stats().lingering, 1u);
+    EXPECT_EQ(manager.CollectGarbage(), 0u);
+
+    auto again = manager.Get("TEST:LINGER1");
+    EXPECT_EQ(again.get(), first);
+    // A second owner shares the live lease
+    auto shared = manager.Get("TEST:LINGER1");
+    EXPECT_EQ(shared.get(), first);
+
+    const auto stats = manager.Stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.linger_hits, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.lingering, 0u);
+}
+
+TEST(PVManagerLingerTest, EvictsLeastRecentlyReleasedOverLimit) {
+    PVManager manager(std::make_shared<CAContextManager>());
+    manager.SetLingerPolicy({2, std::chrono::minutes(1)});
+
+    for (const char* name : {"TEST:LRU_A", "TEST:LRU_B", "TEST:LRU_C"}) {
+        manager.Get(name);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EXPECT_EQ(manager.Stats().lingering, 3u);
+
+    EXPECT_EQ(manager.CollectGarbage(), 1u);
+    EXPECT_EQ(manager.RegistrySize(), 2u);
+    EXPECT_EQ(manager.Stats().evictions, 1u);
+
+    // B and C are still warm; A was closed and needs a new channel
+    manager.Get("TEST:LRU_B");
+    manager.Get("TEST:LRU_C");
+    EXPECT_EQ(manager.Stats().misses, 3u);
+    manager.Get("TEST:LRU_A");
+    EXPECT_EQ(manager.Stats().misses, 4u);
+}
+
+TEST(PVManagerLingerTest, EvictsAfterMaxIdle) {
+    PVManager manager(std::make_shared<CAContextManager>());
+    manager.SetLingerPolicy({8, std::chrono::milliseconds(5)});
+
+    manager.Get("TEST:IDLE");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    EXPECT_EQ(manager.CollectGarbage(), 1u);
+    EXPECT_EQ(manager.RegistrySize(), 0u);
+    EXPECT_EQ(manager.Stats().lingering, 0u);
+}
+
+// Tick loops call this every tick; it only does the work once per interval
+TEST(PVManagerLingerTest, CollectGarbageIfDueIsRateLimited) {
+    PVManager manager(std::make_shared<CAContextManager>());
+    manager.SetLingerPolicy({8, std::chrono::milliseconds(20)});
+
+    EXPECT_EQ(manager.CollectGarbageIfDue(), 0u);  // nothing idle yet
+    manager.Get("TEST:IDLE_DUE");
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(manager.Stats().lingering, 1u);
+
+    // Due again after max_idle, which is shorter than kCollectInterval
+    EXPECT_EQ(manager.CollectGarbageIfDue(), 1u);
+    EXPECT_EQ(manager.Stats().lingering, 0u);
+
+    manager.Get("TEST:IDLE_DUE");
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_EQ(manager.CollectGarbageIfDue(), 1u);
+    EXPECT_EQ(manager.CollectGarbageIfDue(), 0u);
+}
+
+TEST_F(SoftIocFixture, PVManager_Prewarm_ConnectsAllAndSharesInstances) {
+    PVManager manager(ctx_);
+
+    auto pvs = manager.Prewarm({"TEST:AO", "TEST:LO", "TEST:STRO"});
+    ASSERT_EQ(pvs.size(), 3u);
+    EXPECT_EQ(manager.RegistrySize(), 3u);
+
+    for (auto& pv : pvs) {
+        EXPECT_TRUE(WaitUntilConnected(*pv)) << pv->GetPVname();
+    }
+
+    // Nodes resolving the same name later get the warmed channel
+    EXPECT_EQ(manager.Get("TEST:LO").get(), pvs[1].get());
+}
@@ -0,0 +1,332 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "epics/ca/ca_context_manager.h"
+#include "epics/ca/ca_pv.h"
+#include "helper_func.h"
+#include "softioc_fixture.h"
+
+using namespace std::chrono_literals;
+using bchtree::epics::ca::CallbackDispatcher;
+using bchtree::epics::ca::CAContextManager;
+using bchtree::epics::ca::CAPV;
+using bchtree::epics::ca::DispatchPolicy;
+
+namespace {
+
+// Records the order and thread of delivered events
+struct Recorder {
+    std::mutex mtx;
+    std::vector<uintptr_t> delivered;
+    std::vector<uintptr_t> dropped;
+    std::thread::id thread;
+
+    static void Run(void* arg, uintptr_t data, bool run) {
+        auto* self = static_cast<Recorder*>(arg);
+        std::lock_guard<std::mutex> lock(self->mtx);
+        (run ? self->delivered : self->dropped).push_back(data);
+        self->thread = std::this_thread::get_id();
+    }
+};
+
+// Blocks the delivering thread until released
+struct Gate {
+    std::promise<void> entered;
+    std::promise<void> release;
+    std::shared_future<void> released{release.get_future().share()};
+
+    static void Run(void* arg, uintptr_t, bool run) {
+        if (!run) return;
+        auto* self = static_cast<Gate*>(arg);
+        self->entered.set_value();
+        self->released.wait();
+    }
+};
+
+std::shared_ptr<CAContextManager> MakeContext(const DispatchPolicy& policy) {
+    auto ctx = std::make_shared<CAContextManager>();
+    ctx->Init();
+    ctx->Dispatcher().SetPolicy(policy);
+    return ctx;
+}
+
+bool WaitFor(const std::function<bool()>& pred,
+             std::chrono::milliseconds timeout = 2000ms) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(5ms);
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST(DispatchPolicyTest, Parse) {
+    EXPECT_EQ(DispatchPolicy::Parse("inline").mode,
+              DispatchPolicy::Mode::kInline);
+    EXPECT_EQ(DispatchPolicy::Parse("tick").mode, DispatchPolicy::Mode::kTick);
+
+    const auto workers = DispatchPolicy::Parse("3");
+    EXPECT_EQ(workers.mode, DispatchPolicy::Mode::kWorkers);
+    EXPECT_EQ(workers.workers, 3u);
+
+    EXPECT_THROW(DispatchPolicy::Parse("0"), std::invalid_argument);
+    EXPECT_THROW(DispatchPolicy::Parse("many"), std::invalid_argument);
+}
+
+TEST(CallbackDispatcherTest, Inline_DeliversOnCaller) {
+    auto ctx = MakeContext({});
+    Recorder rec;
+    ctx->Dispatcher().Post(&rec, &Recorder::Run, &rec, 7);
+
+    EXPECT_EQ(rec.delivered, std::vector<uintptr_t>{7});
+    EXPECT_EQ(rec.thread, std::this_thread::get_id());
+    EXPECT_EQ(ctx->Dispatcher().Stats().posted, 0u);
+}
+
+TEST(CallbackDispatcherTest, Workers_DeliverInOrderPerOwner) {
+    DispatchPolicy policy;
+    policy.mode = DispatchPolicy::Mode::kWorkers;
+    policy.workers = 2;
+    auto ctx = MakeContext(policy);
+    auto& dispatcher = ctx->Dispatcher();
+
+    Recorder rec;
+    for (uintptr_t i = 0; i < 100; ++i) {
+        dispatcher.Post(&rec, &Recorder::Run, &rec, i);
+    }
+    ASSERT_TRUE(WaitFor([&] { return dispatcher.Stats().executed == 100; }));
+
+    std::lock_guard<std::mutex> lock(rec.mtx);
+    ASSERT_EQ(rec.delivered.size(), 100u);
+    for (uintptr_t i = 0; i < 100; ++i) EXPECT_EQ(rec.delivered[i], i);
+    EXPECT_NE(rec.thread, std::this_thread::get_id());
+}
+
+// State events beyond their half of a full ring wait in order in the side
+// queue; the posting thread never blocks
+TEST(CallbackDispatcherTest, FullQueue_DefersStateEvents) {
+    DispatchPolicy policy;
+    policy.mode = DispatchPolicy::Mode::kWorkers;
+    policy.capacity = 2;
+    auto ctx = MakeContext(policy);
+    auto& dispatcher = ctx->Dispatcher();
+
+    Gate gate;
+    Recorder rec;
+    dispatcher.Post(&rec, &Gate::Run, &gate);
+    gate.entered.get_future().wait();  // the worker is busy
+
+    dispatcher.Post(&rec, &Recorder::Run, &rec, 1);  // queued
+    dispatcher.Post(&rec, &Recorder::Run, &rec, 2);  // deferred
+    auto stats = dispatcher.Stats();
+    EXPECT_EQ(stats.deferred, 1u);
+    EXPECT_EQ(stats.depth, 2u);
+    {
+        std::lock_guard<std::mutex> lock(rec.mtx);
+        EXPECT_TRUE(rec.delivered.empty());
+    }
+
+    gate.release.set_value();
+    ASSERT_TRUE(WaitFor([&] { return dispatcher.Stats().executed == 3; }));
+
+    std::lock_guard<std::mutex> lock(rec.mtx);
+    EXPECT_EQ(rec.delivered, (std::vector<uintptr_t>{1, 2}));
+    EXPECT_NE(rec.thread, std::this_thread::get_id());
+}
+
+// Completions use room reserved when the request was issued; a request
+// finding no room is refused instead
+TEST(CallbackDispatcherTest, Reserve_KeepsRoomForCompletions) {
+    DispatchPolicy policy;
+    policy.mode = DispatchPolicy::Mode::kTick;
+    policy.capacity = 2;
+    auto ctx = MakeContext(policy);
+    auto& dispatcher = ctx->Dispatcher();
+
+    Recorder rec;
+    ASSERT_TRUE(dispatcher.Reserve(&rec));
+    dispatcher.Post(&rec, &Recorder::Run, &rec, 1);  // fills the ring
+    EXPECT_FALSE(dispatcher.Reserve(&rec));
+    dispatcher.Post(&rec, &Recorder::Run, &rec, 2);  // deferred
+    dispatcher.PostReserved(&rec, &Recorder::Run, &rec, 3);
+
+    auto stats = dispatcher.Stats();
+    EXPECT_EQ(stats.rejected, 1u);
+    EXPECT_EQ(stats.deferred, 1u);
+    EXPECT_EQ(stats.depth, 3u);
+
+    // The deferred state event follows the completion
+    EXPECT_EQ(dispatcher.Drain(), 3u);
+    EXPECT_EQ(rec.delivered, (std::vector<uintptr_t>{1, 3, 2}));
+
+    // Returned room can be reserved again
+    ASSERT_TRUE(dispatcher.Reserve(&rec));
+    ASSERT_TRUE(dispatcher.Reserve(&rec));
+    EXPECT_FALSE(dispatcher.Reserve(&rec));
+    dispatcher.Unreserve(&rec, 2);
+    EXPECT_TRUE(dispatcher.Reserve(&rec));
+    dispatcher.Unreserve(&rec);
+}
+
+// The tick ring keeps its size; its consumer is never waited for
+TEST(CallbackDispatcherTest, Tick_FullQueueDoesNotGrow) {
+    DispatchPolicy policy;
+    policy.mode = DispatchPolicy::Mode::kTick;
+    policy.capacity = 2;
+    auto ctx = MakeContext(policy);
+    auto& dispatcher = ctx->Dispatcher();
+
+    Recorder rec;
+    for (uintptr_t i = 0; i < 5; ++i) {
+        dispatcher.Post(&rec, &Recorder::Run, &rec, i);
+    }
+    EXPECT_TRUE(rec.delivered.empty());
+    auto stats = dispatcher.Stats();
+    EXPECT_EQ(stats.depth, 5u);
+    EXPECT_EQ(stats.deferred, 4u);
+    EXPECT_LE(stats.high_water, 2u);
+
+    EXPECT_EQ(dispatcher.Drain(), 5u);
+    EXPECT_EQ(rec.delivered, (std::vector<uintptr_t>{0, 1, 2, 3, 4}));
+}
+
+TEST(CallbackDispatcherTest, Cancel_DropsQueuedAndWaitsForRunning) {
+    DispatchPolicy policy;
+    policy.mode = DispatchPolicy::Mode::kWorkers;
+    auto ctx = MakeContext(policy);
+    auto& dispatcher = ctx->Dispatcher();
+
+    Gate gate;
+    Recorder rec;
+    dispatcher.Post(&rec, &Gate::Run, &gate);
+    gate.entered.get_future().wait();
+    dispatcher.Post(&rec, &Recorder::Run, &rec, 1);
+    dispatcher.Post(&rec, &Recorder::Run, &rec, 2);
+
+    auto cancelled = std::async(std::launch::async,
+                                [&] { dispatcher.Cancel(&rec); });
+    // Blocked on the running event
+    EXPECT_EQ(cancelled.wait_for(100ms), std::future_status::timeout);
+    gate.release.set_value();
+    ASSERT_EQ(cancelled.wait_for(2s), std::future_status::ready);
+
+    std::lock_guard<std::mutex> lock(rec.mtx);
+    EXPECT_TRUE(rec.delivered.empty());
+    EXPECT_EQ(rec.dropped, (std::vector<uintptr_t>{1, 2}));
+    EXPECT_EQ(dispatcher.Stats().cancelled, 2u);
+}
+
+TEST(CallbackDispatcherTest, Tick_DeliversOnDrain) {
+    DispatchPolicy policy;
+    policy.mode = DispatchPolicy::Mode::kTick;
+    auto ctx = MakeContext(policy);
+    auto& dispatcher = ctx->Dispatcher();
+
+    EXPECT_FALSE(dispatcher.WaitForEvents(10ms));
+
+    Recorder rec;
+    std::thread producer(
+        [&] { dispatcher.Post(&rec, &Recorder::Run, &rec, 5); });
+    producer.join();
+    EXPECT_TRUE(rec.delivered.empty());
+
+    EXPECT_TRUE(dispatcher.WaitForEvents(1s));
+    EXPECT_EQ(dispatcher.Drain(), 1u);
+    EXPECT_EQ(rec.delivered, std::vector<uintptr_t>{5});
+    EXPECT_EQ(rec.thread, std::this_thread::get_id());
+}
+
+// Events another tick thread is draining do not wake the waiter, which
+// would otherwise spin on Drain() returning 0
+TEST(CallbackDispatcherTest, Tick_WaitIgnoresEventsBeingDrained) {
+    DispatchPolicy policy;
+    policy.mode = DispatchPolicy::Mode::kTick;
+    auto ctx = MakeContext(policy);
+    auto& dispatcher = ctx->Dispatcher();
+
+    Gate gate;
+    Recorder rec;
+    dispatcher.Post(&rec, &Gate::Run, &gate);
+    dispatcher.Post(&rec, &Recorder::Run, &rec, 1);
+    auto drained = std::async(std::launch::async,
+                              [&] { return dispatcher.Drain(); });
+    gate.entered.get_future().wait();  // the other thread is draining
+
+    EXPECT_FALSE(dispatcher.WaitForEvents(50ms));
+    EXPECT_EQ(dispatcher.Drain(), 0u);
+
+    gate.release.set_value();
+    EXPECT_EQ(drained.get(), 2u);
+    EXPECT_EQ(rec.delivered, std::vector<uintptr_t>{1});
+}
+
+// CAPV callbacks run on dispatcher threads, never on CA's
+TEST_F(SoftIocFixture, CAPV_Workers_RunCallbacksOffCAThreads) {
+    DispatchPolicy policy;
+    policy.mode = DispatchPolicy::Mode::kWorkers;
+    auto ctx = MakeContext(policy);
+
+    CAPV pv(ctx, "TEST:AO");
+    std::promise<std::thread::id> conn_thread;
+    std::atomic<bool> conn_seen{false};
+    pv.AddConnCB([&](bool connected) {
+        if (connected && !conn_seen.exchange(true)) {
+            conn_thread.set_value(std::this_thread::get_id());
+        }
+    });
+    std::atomic<int> monitors{0};
+    pv.AddMonitorCB([&] { ++monitors; });
+    pv.Connect();
+    ASSERT_TRUE(WaitUntilConnected(pv));
+
+    auto conn_future = conn_thread.get_future();
+    ASSERT_EQ(conn_future.wait_for(2s), std::future_status::ready);
+    const std::thread::id worker = conn_future.get();
+    EXPECT_NE(worker, std::this_thread::get_id());
+
+    std::promise<std::thread::id> get_thread;
+    ASSERT_TRUE(pv.GetCBAs<double>(
+        [&](double) { get_thread.set_value(std::this_thread::get_id()); },
+        1000ms));
+    auto get_future = get_thread.get_future();
+    ASSERT_EQ(get_future.wait_for(2s), std::future_status::ready);
+    // One owner, one worker
+    EXPECT_EQ(get_future.get(), worker);
+
+    ASSERT_TRUE(WaitFor([&] { return monitors > 0; }));
+    EXPECT_GT(ctx->Dispatcher().Stats().executed, 0u);
+}
+
+// A callback stuck in user code does not hold up CA: values still arrive
+TEST_F(SoftIocFixture, CAPV_Workers_SlowCallbackDoesNotStallCA) {
+    DispatchPolicy policy;
+    policy.mode = DispatchPolicy::Mode::kWorkers;
+    auto ctx = MakeContext(policy);
+
+    CAPV pv(ctx, "TEST:LO");
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<bool> blocked{false};
+    pv.AddMonitorCB([&] {
+        if (!blocked.exchange(true)) released.wait();
+    });
+    pv.Connect();
+    ASSERT_TRUE(WaitUntilConnected(pv));
+    ASSERT_TRUE(WaitFor([&] { return blocked.load(); }));
+
+    ASSERT_EQ(system("caput -t TEST:LO 4321"), 0);
+    EXPECT_TRUE(WaitFor([&] { return pv.GetAs<int>() == 4321; }));
+
+    release.set_value();
+}
@@ -0,0 +1,205 @@
+#include <cadef.h>
+#include <db_access.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "epics/ca/ca_pv.h"
+#include "epics/ca/dbr_decode.h"
+#include "helper_func.h"
+#include "softioc_fixture.h"
+
+using namespace std::chrono_literals;
+using bchtree::epics::PVControlInfo;
+using bchtree::epics::PVData;
+using bchtree::epics::PVType;
+using bchtree::epics::ca::CAPV;
+using bchtree::epics::ca::DecodeControlInfo;
+using bchtree::epics::ca::DecodeDbr;
+
+TEST(DbrDecodeTest, TimeTypesFillMeta) {
+    dbr_time_double dbr{};
+    dbr.status = 3;     // HIGH
+    dbr.severity = 1;   // MINOR
+    dbr.stamp.secPastEpoch = 1000;
+    dbr.stamp.nsec = 500;
+    dbr.value = 4.5;
+
+    const PVData data = DecodeDbr(DBR_TIME_DOUBLE, 1, &dbr, false);
+    EXPECT_DOUBLE_EQ(data.As<double>(), 4.5);
+    EXPECT_EQ(data.meta.status, 3u);
+    EXPECT_EQ(data.meta.severity, 1u);
+    const auto since_epoch = data.meta.timestamp.time_since_epoch();
+    EXPECT_EQ(std::chrono::duration_cast<std::chrono::seconds>(since_epoch)
+                  .count(),
+              1000 + POSIX_TIME_AT_EPICS_EPOCH);
+}
+
+TEST(DbrDecodeTest, CharIsNumericScalar) {
+    dbr_time_char dbr{};
+    dbr.value = 65;
+    const PVData data = DecodeDbr(DBR_TIME_CHAR, 1, &dbr, false);
+    EXPECT_EQ(data.Type(), PVType::kLong);
+    EXPECT_EQ(data.As<int32_t>(), 65);
+}
+
+TEST(DbrDecodeTest, CtrlAndGrTypesDecodeValue) {
+    dbr_ctrl_enum en{};
+    en.severity = 2;
+    en.no_str = 2;
+    en.value = 1;
+    const PVData e = DecodeDbr(DBR_CTRL_ENUM, 1, &en, false);
+    EXPECT_EQ(e.Type(), PVType::kEnum);
+    EXPECT_EQ(e.As<uint16_t>(), 1);
+    EXPECT_EQ(e.meta.severity, 2u);
+
+    dbr_gr_long gr{};
+    gr.value = -7;
+    EXPECT_EQ(DecodeDbr(DBR_GR_LONG, 1, &gr, false).As<int32_t>(), -7);
+
+    dbr_ctrl_float ctrl{};
+    ctrl.value = 0.25f;
+    EXPECT_FLOAT_EQ(DecodeDbr(DBR_CTRL_FLOAT, 1, &ctrl, false).As<float>(),
+                    0.25f);
+
+    dbr_sts_string str{};
+    std::strcpy(str.value, "ready");
+    EXPECT_EQ(DecodeDbr(DBR_CTRL_STRING, 1, &str, false).As<std::string>(),
+              "ready");
+}
+
+TEST(DbrDecodeTest, ControlInfo_Double) {
+    dbr_ctrl_double dbr{};
+    std::strcpy(dbr.units, "mm");
+    dbr.precision = 3;
+    dbr.lower_disp_limit = -20.0;
+    dbr.upper_disp_limit = 20.0;
+    dbr.lower_ctrl_limit = -10.0;
+    dbr.upper_ctrl_limit = 10.0;
+
+    const PVControlInfo info = DecodeControlInfo(DBR_CTRL_DOUBLE, &dbr);
+    EXPECT_EQ(info.units, "mm");
+    EXPECT_EQ(info.precision, 3);
+    EXPECT_DOUBLE_EQ(info.display_low, -20.0);
+    EXPECT_DOUBLE_EQ(info.display_high, 20.0);
+    EXPECT_TRUE(info.HasControlLimits());
+    EXPECT_TRUE(info.WithinControlLimits(10.0));
+    EXPECT_FALSE(info.WithinControlLimits(10.5));
+    EXPECT_TRUE(info.enum_strings.empty());
+
+    // GR types carry no control limits
+    dbr_gr_long gr{};
+    gr.upper_disp_limit = 5;
+    const PVControlInfo gr_info = DecodeControlInfo(DBR_GR_LONG, &gr);
+    EXPECT_DOUBLE_EQ(gr_info.display_high, 5.0);
+    EXPECT_FALSE(gr_info.HasControlLimits());
+    EXPECT_TRUE(gr_info.WithinControlLimits(1e9));
+}
+
+TEST(DbrDecodeTest, ControlInfo_EnumStrings) {
+    dbr_ctrl_enum dbr{};
+    dbr.no_str = 2;
+    std::strcpy(dbr.strs[0], "Off");
+    std::strcpy(dbr.strs[1], "On");
+
+    const PVControlInfo info = DecodeControlInfo(DBR_CTRL_ENUM, &dbr);
+    ASSERT_EQ(info.enum_strings.size(), 2u);
+    EXPECT_EQ(info.EnumString(1), "On");
+    EXPECT_TRUE(info.EnumString(2).empty());
+    EXPECT_EQ(info.EnumIndex("Off"), std::optional<uint16_t>(0));
+    EXPECT_FALSE(info.EnumIndex("Unknown").has_value());
+
+    dbr_time_double time{};
+    EXPECT_THROW(DecodeControlInfo(DBR_TIME_DOUBLE, &time), std::runtime_error);
+}
+
+TEST(DbrDecodeTest, UnknownTypeThrows) {
+    dbr_time_double dbr{};
+    EXPECT_THROW(DecodeDbr(DBR_PUT_ACKT, 1, &dbr, false),
+                 std::runtime_error);
+    EXPECT_THROW(DecodeDbr(DBR_CLASS_NAME, 1, &dbr, false),
+                 std::runtime_error);
+    EXPECT_THROW(DecodeDbr(LAST_BUFFER_TYPE + 1, 1, &dbr, false),
+                 std::runtime_error);
+}
+
+TEST_F(SoftIocFixture, CAPV_CharWaveform_ReadsAsLongString) {
+    CAPV pv(ctx_, "TEST:CHARWF");
+    pv.Connect();
+    ASSERT_TRUE(WaitUntilConnected(pv));
+
+    // Longer than a DBR_STRING
+    const std::string text(100, 'c');
+    std::vector<uint8_t> bytes(text.begin(), text.end());
+    bytes.push_back('\0');
+
+    std::promise<bool> put;
+    ASSERT_TRUE(pv.PutCB(bchtree::epics::PVArrayValue{bytes},
+                         [&](bool success) { put.set_value(success); }));
+    ASSERT_EQ(put.get_future().wait_for(4s), std::future_status::ready);
+
+    std::promise<std::string> got;
+    ASSERT_TRUE(pv.GetCBAs<std::string>(
+        [&](std::string s) { got.set_value(std::move(s)); },
+        std::chrono::milliseconds(1000)));
+    auto fut = got.get_future();
+    ASSERT_EQ(fut.wait_for(4s), std::future_status::ready);
+    EXPECT_EQ(fut.get(), text);
+}
+
+TEST_F(SoftIocFixture, CAPV_BinaryRecord_DecodesEnumWithTimestamp) {
+    // The IOC is shared by the suite; other tests write TEST:BO
+    ASSERT_EQ(system("caput -t TEST:BO 0"), 0);
+    CAPV pv(ctx_, "TEST:BO");
+    pv.Connect();
+    ASSERT_TRUE(WaitUntilConnected(pv));
+
+    const auto deadline = std::chrono::steady_clock::now() + 4s;
+    while (!pv.HasValue() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(10ms);
+    }
+    ASSERT_TRUE(pv.HasValue());
+
+    const auto snap = pv.Snapshot();
+    EXPECT_EQ(snap->Type(), PVType::kEnum);
+    EXPECT_EQ(snap->As<uint16_t>(), 0);
+    EXPECT_NE(snap->meta.timestamp.time_since_epoch().count(), 0);
+}
+
+TEST_F(SoftIocFixture, CAPV_ControlInfo_CachedOnConnect) {
+    // The IOC is shared by the suite; other tests write TEST:BO
+    ASSERT_EQ(system("caput -t TEST:BO 0"), 0);
+    CAPV bo(ctx_, "TEST:BO");
+    CAPV ao(ctx_, "TEST:AOLIM");
+    bo.Connect();
+    ao.Connect();
+    ASSERT_TRUE(WaitUntilConnected(bo));
+    ASSERT_TRUE(WaitUntilConnected(ao));
+
+    const auto deadline = std::chrono::steady_clock::now() + 4s;
+    while ((!bo.ControlInfo() || !ao.ControlInfo() || !bo.HasValue()) &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(10ms);
+    }
+    ASSERT_TRUE(bo.ControlInfo());
+    ASSERT_TRUE(ao.ControlInfo());
+
+    EXPECT_EQ(bo.ControlInfo()->enum_strings,
+              (std::vector<std::string>{"Off", "On"}));
+    // Enum values read as strings map to their state string
+    EXPECT_EQ(bo.GetAs<std::string>(), "Off");
+    EXPECT_EQ(bo.GetAs<int>(), 0);
+
+    const auto info = ao.ControlInfo();
+    EXPECT_EQ(info->units, "mm");
+    EXPECT_EQ(info->precision, 3);
+    EXPECT_DOUBLE_EQ(info->control_low, -10.0);
+    EXPECT_DOUBLE_EQ(info->control_high, 10.0);
+}
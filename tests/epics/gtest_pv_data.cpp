@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "epics/types.h"
+
+using bchtree::epics::PVArrayValue;
+using bchtree::epics::PVData;
+using bchtree::epics::PVType;
+
+TEST(PVDataTest, IsCompact) {
+    // Inline DBR string plus meta and count fit one cache line
+    EXPECT_LE(sizeof(PVData), 64u);
+}
+
+TEST(PVDataTest, DefaultReadsAsZero) {
+    PVData data;
+    EXPECT_EQ(data.Type(), PVType::kLong);
+    EXPECT_EQ(data.As<int32_t>(), 0);
+    EXPECT_DOUBLE_EQ(data.As<double>(), 0.0);
+    EXPECT_THROW(data.As<std::string>(), std::runtime_error);
+}
+
+TEST(PVDataTest, ScalarConversions) {
+    const auto d = PVData::FromDouble(2.75);
+    EXPECT_EQ(d.Type(), PVType::kDouble);
+    EXPECT_FALSE(d.IsArray());
+    EXPECT_DOUBLE_EQ(d.As<double>(), 2.75);
+    EXPECT_FLOAT_EQ(d.As<float>(), 2.75f);
+    EXPECT_EQ(d.As<int32_t>(), 2);
+    EXPECT_EQ(d.As<std::vector<double>>(), std::vector<double>{2.75});
+
+    const auto e = PVData::FromEnum(3);
+    EXPECT_EQ(e.As<uint16_t>(), 3);
+    EXPECT_EQ(e.As<int32_t>(), 3);
+}
+
+TEST(PVDataTest, StringIsInlineAndBounded) {
+    const char raw[] = "Hello";
+    const auto s = PVData::FromString(raw);
+    EXPECT_EQ(s.Type(), PVType::kString);
+    EXPECT_EQ(s.StringView(), "Hello");
+    EXPECT_EQ(s.As<std::string>(), "Hello");
+    EXPECT_THROW(s.As<double>(), std::runtime_error);
+
+    // A full DBR_STRING need not be NUL terminated
+    char full[PVData::kMaxString];
+    std::fill(std::begin(full), std::end(full), 'x');
+    EXPECT_EQ(PVData::FromString(full).As<std::string>().size(),
+              PVData::kMaxString);
+}
+
+TEST(PVDataTest, ArrayPayloadIsSharedByCopies) {
+    auto a = PVData::FromArray(PVArrayValue{std::vector<float>{1.5f, 2.5f}});
+    a.count = 2;
+    const PVData copy = a;
+
+    EXPECT_TRUE(copy.IsArray());
+    EXPECT_EQ(copy.Type(), PVType::kFloat);
+    EXPECT_EQ(copy.count, 2u);
+    EXPECT_EQ(copy.Array(), a.Array());
+    EXPECT_EQ(copy.As<std::vector<double>>(),
+              (std::vector<double>{1.5, 2.5}));
+    EXPECT_DOUBLE_EQ(copy.As<double>(), 1.5);
+
+    PVData moved = std::move(a);
+    EXPECT_EQ(moved.Array(), copy.Array());
+    EXPECT_FALSE(a.IsArray());  // NOLINT(bugprone-use-after-move)
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "epics/ca/pv_handle.h"
+#include "helper_func.h"
+#include "softioc_fixture.h"
+
+using namespace bchtree::epics::ca;
+
+TEST(PVHandleTest, ResolveOnlyChangesOnNewName) {
+    auto manager = std::make_shared<PVManager>(
+        std::make_shared<CAContextManager>());
+    PVHandle handle(manager, nullptr, nullptr);
+    EXPECT_FALSE(handle.IsResolved());
+
+    EXPECT_TRUE(handle.Resolve("TEST:HANDLE1"));
+    EXPECT_EQ(handle.Name(), "TEST:HANDLE1");
+    EXPECT_EQ(handle.Get().get(), manager->Get("TEST:HANDLE1").get());
+
+    // Same name: no lookup, same channel
+    auto* before = handle.Get().get();
+    EXPECT_FALSE(handle.Resolve("TEST:HANDLE1"));
+    EXPECT_EQ(handle.Get().get(), before);
+
+    // New name: switches channel
+    EXPECT_TRUE(handle.Resolve("TEST:HANDLE2"));
+    EXPECT_EQ(handle.Name(), "TEST:HANDLE2");
+    EXPECT_NE(handle.Get().get(), before);
+}
+
+TEST_F(SoftIocFixture, PVHandle_CallbacksFollowResolvedChannel) {
+    auto manager = std::make_shared<PVManager>(ctx_);
+
+    std::atomic<int> conn_events{0};
+    PVHandle handle(
+        manager, [&](bool up) { conn_events += up ? 1 : 0; }, nullptr);
+
+    handle.Resolve("TEST:LO");
+    handle->Connect();
+    ASSERT_TRUE(WaitUntilConnected(*handle.Get()));
+    EXPECT_EQ(conn_events, 1);
+
+    // Switching channels moves the callback to the new CAPV
+    handle.Resolve("TEST:AO");
+    handle->Connect();
+    ASSERT_TRUE(WaitUntilConnected(*handle.Get()));
+    EXPECT_EQ(conn_events, 2);
+}
+
+// A reply that arrives after the handle is gone is dropped, even though
+// the channel itself is still alive (shared or lingering)
+TEST_F(SoftIocFixture, PVHandle_DropsCompletionsAfterDestruction) {
+    auto ctx = std::make_shared<CAContextManager>();
+    ctx->Init();
+    // Replies wait in the queue until Drain()
+    DispatchPolicy policy;
+    policy.mode = DispatchPolicy::Mode::kTick;
+    ctx->Dispatcher().SetPolicy(policy);
+    auto manager = std::make_shared<PVManager>(ctx);
+
+    PVHandle keeper(manager, nullptr, nullptr);
+    keeper.Resolve("TEST:AO");
+    keeper->Connect();
+    ASSERT_TRUE(WaitUntilConnected(*keeper.Get()));
+
+    std::atomic<int> dropped{0};
+    {
+        PVHandle handle(manager, nullptr, nullptr);
+        handle.Resolve("TEST:AO");
+        ASSERT_TRUE(handle.PutCB(bchtree::epics::PVScalarValue{1.0},
+                                 [&](bool) { ++dropped; }));
+        ASSERT_TRUE(handle.GetCBAs<double>([&](double) { ++dropped; },
+                                           std::chrono::milliseconds(1000)));
+    }
+
+    // Replies on one channel arrive in order, so once the keeper's get is
+    // delivered the others have been drained too
+    std::atomic<bool> delivered{false};
+    ASSERT_TRUE(keeper.GetCBAs<double>([&](double) { delivered = true; },
+                                       std::chrono::milliseconds(1000)));
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!delivered && std::chrono::steady_clock::now() < deadline) {
+        ctx->Dispatcher().WaitForEvents(std::chrono::milliseconds(10));
+        ctx->Dispatcher().Drain();
+    }
+    ASSERT_TRUE(delivered);
+    EXPECT_EQ(dropped, 0);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "bt_runner.h"
+#include "softioc_fixture.h"
+
+using namespace bchtree;
+using namespace std::chrono_literals;
+
+namespace {
+
+void WriteTree(const std::filesystem::path& path, int sleep_msec) {
+    // Write then rename, like most editors
+    const auto tmp = path.string() + ".tmp";
+    {
+        std::ofstream ofs(tmp, std::ios::trunc);
+        ofs << "<root BTCPP_format=\"4\">\n"
+               "  <BehaviorTree ID=\"MainTree\">\n"
+               "    <Sequence>\n"
+               "      <CAGetDouble pv=\"TEST:AO\" timeout=\"1000\" "
+               "result=\"{v}\"/>\n"
+               "      <Sleep msec=\""
+            << sleep_msec
+            << "\"/>\n"
+               "    </Sequence>\n"
+               "  </BehaviorTree>\n"
+               "</root>\n";
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+}  // namespace
+
+TEST_F(SoftIocFixture, BTRunner_HotReloadKeepsChannels) {
+    const auto dir = std::filesystem::path(::testing::TempDir()) / "reload";
+    std::filesystem::create_directories(dir);
+    const auto path = dir / "tree.xml";
+    WriteTree(path, 60000);
+
+    auto pv_manager = std::make_shared<epics::ca::PVManager>(ctx_);
+    BTRunner runner(ctx_, pv_manager);
+    runner.EnableHotReload();
+    runner.RegisterTreeFromFile(path.string());
+
+    std::weak_ptr<epics::ca::CAPV> channel = pv_manager->Get("TEST:AO");
+    ASSERT_FALSE(channel.expired());
+
+    auto result = std::async(std::launch::async,
+                             [&runner] { return runner.Run(10ms); });
+    std::this_thread::sleep_for(300ms);
+
+    // The reloaded tree sleeps briefly instead of a minute
+    WriteTree(path, 10);
+    ASSERT_EQ(result.wait_for(5s), std::future_status::ready);
+    EXPECT_TRUE(result.get());
+
+    // Same CAPV throughout: the channel was never torn down
+    EXPECT_FALSE(channel.expired());
+    EXPECT_EQ(pv_manager->Get("TEST:AO").get(), channel.lock().get());
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "daemon_server.h"
+#include "softioc_fixture.h"
+
+using namespace bchtree;
+
+TEST(DaemonServerTest, RequestRoundTrip) {
+    DaemonRequest request{"/trees/main.xml", {{"mode", "fast"}, {"n", "1"}}};
+    const std::string line = EncodeDaemonRequest(request);
+    ASSERT_EQ(line.back(), '\n');
+
+    DaemonRequest decoded;
+    ASSERT_TRUE(
+        DecodeDaemonRequest(line.substr(0, line.size() - 1), decoded));
+    EXPECT_EQ(decoded.tree_path, request.tree_path);
+    EXPECT_EQ(decoded.globals, request.globals);
+
+    EXPECT_FALSE(DecodeDaemonRequest("run", decoded));
+    EXPECT_FALSE(DecodeDaemonRequest("stop\t/a.xml", decoded));
+    EXPECT_FALSE(DecodeDaemonRequest("run\t/a.xml\tnovalue", decoded));
+    EXPECT_THROW(EncodeDaemonRequest({"bad\tpath", {}}),
+                 std::invalid_argument);
+}
+
+TEST(DaemonServerTest, ReplyRoundTrip) {
+    DaemonReply reply;
+    ASSERT_TRUE(DecodeDaemonReply("SUCCESS\t1.500\t20.250", reply));
+    EXPECT_EQ(reply.status, "SUCCESS");
+    EXPECT_DOUBLE_EQ(reply.load_ms, 1.5);
+    EXPECT_DOUBLE_EQ(reply.run_ms, 20.25);
+
+    DaemonReply error{"ERROR", 0.0, 0.0, "no\tsuch file"};
+    const std::string line = EncodeDaemonReply(error);
+    ASSERT_TRUE(DecodeDaemonReply(line.substr(0, line.size() - 1), reply));
+    EXPECT_EQ(reply.status, "ERROR");
+    EXPECT_EQ(reply.error, "no such file");
+
+    EXPECT_FALSE(DecodeDaemonReply("MAYBE\t1\t2", reply));
+}
+
+TEST(DaemonServerTest, RunsSubmittedTrees) {
+    const auto dir = std::filesystem::path(::testing::TempDir());
+    const auto tree = dir / "daemon_tree.xml";
+    {
+        std::ofstream ofs(tree);
+        ofs << "<root BTCPP_format=\"4\">\n"
+               "  <BehaviorTree ID=\"MainTree\">\n"
+               "    <Print message=\"{greeting}\"/>\n"
+               "  </BehaviorTree>\n"
+               "</root>\n";
+    }
+    const std::string socket_path =
+        (dir / ("bch-daemon-" + std::to_string(::getpid()) + ".sock"))
+            .string();
+
+    auto ctx = std::make_shared<epics::ca::CAContextManager>();
+    auto pv_manager = std::make_shared<epics::ca::PVManager>(ctx);
+    DaemonServer server(ctx, pv_manager);
+    server.Listen(socket_path);
+    std::thread serve([&] { server.Serve(std::chrono::milliseconds(1)); });
+
+    const auto ok =
+        SubmitToDaemon(socket_path, {tree.string(), {{"greeting", "hi"}}});
+    EXPECT_EQ(ok.status, "SUCCESS");
+
+    // Missing port value makes Print throw; reported as ERROR, daemon lives
+    const auto failed = SubmitToDaemon(socket_path, {tree.string(), {}});
+    EXPECT_EQ(failed.status, "ERROR");
+
+    const auto again =
+        SubmitToDaemon(socket_path, {tree.string(), {{"greeting", "hi"}}});
+    EXPECT_EQ(again.status, "SUCCESS");
+
+    server.Stop();
+    serve.join();
+}
+
+// The runner of a request releases its channels; with the daemon's linger
+// limit the next request gets them back connected instead of searching
+TEST_F(SoftIocFixture, DaemonServer_SecondRequestReusesChannel) {
+    const auto dir = std::filesystem::path(::testing::TempDir());
+    const auto tree = dir / "daemon_ca_tree.xml";
+    {
+        std::ofstream ofs(tree);
+        ofs << "<root BTCPP_format=\"4\">\n"
+               "  <BehaviorTree ID=\"MainTree\">\n"
+               "    <CAGetDouble pv=\"TEST:AO\" result=\"{value}\"/>\n"
+               "  </BehaviorTree>\n"
+               "</root>\n";
+    }
+    const std::string socket_path =
+        (dir / ("bch-daemon-ca-" + std::to_string(::getpid()) + ".sock"))
+            .string();
+
+    auto pv_manager = std::make_shared<epics::ca::PVManager>(ctx_);
+    pv_manager->SetLingerPolicy({DaemonServer::kDefaultLingerChannels});
+    DaemonServer server(ctx_, pv_manager);
+    server.Listen(socket_path);
+    std::thread serve([&] { server.Serve(std::chrono::milliseconds(1)); });
+
+    EXPECT_EQ(SubmitToDaemon(socket_path, {tree.string(), {}}).status,
+              "SUCCESS");
+    auto stats = pv_manager->Stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.lingering, 1u);
+
+    // Connected already: no new channel, and no wait for a CA search
+    ASSERT_TRUE(pv_manager->Get("TEST:AO")->IsConnected());
+    const uint64_t linger_hits = pv_manager->Stats().linger_hits;
+    EXPECT_EQ(SubmitToDaemon(socket_path, {tree.string(), {}}).status,
+              "SUCCESS");
+    stats = pv_manager->Stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_GT(stats.linger_hits, linger_hits);
+
+    server.Stop();
+    serve.join();
+}
@@ -0,0 +1,127 @@
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "logger.h"
+
+using namespace bchtree;
+
+namespace {
+
+constexpr int kMessages = 2000;
+
+// Logs to a FIFO that is only read once Release() is called. Until then
+// the logger's worker blocks on the full pipe, so its queue fills up.
+class StalledLogFile {
+   public:
+    StalledLogFile() {
+        path_ = (std::filesystem::path(::testing::TempDir()) /
+                 ("bch-logger-" + std::to_string(::getpid()) + ".fifo"))
+                    .string();
+        std::filesystem::remove(path_);
+        if (::mkfifo(path_.c_str(), 0600) != 0) {
+            throw std::runtime_error("mkfifo failed: " + path_);
+        }
+        // Non-blocking so the logger's open for writing finds a reader
+        fd_ = ::open(path_.c_str(), O_RDONLY | O_NONBLOCK);
+    }
+
+    ~StalledLogFile() {
+        if (reader_.joinable()) reader_.join();
+        if (fd_ >= 0) ::close(fd_);
+        std::filesystem::remove(path_);
+    }
+
+    const std::string& Path() const { return path_; }
+
+    // Drains the pipe until the logger closes it
+    void Release() {
+        ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) & ~O_NONBLOCK);
+        reader_ = std::thread([fd = fd_] {
+            char buf[4096];
+            while (::read(fd, buf, sizeof(buf)) > 0) {
+            }
+        });
+    }
+
+   private:
+    std::string path_;
+    int fd_{-1};
+    std::thread reader_;
+};
+
+std::unique_ptr<Logger> MakeLogger(const std::string& path,
+                                   const std::string& policy) {
+    auto logger = std::make_unique<Logger>();
+    logger->setConsoleLevel("off");
+    logger->setFileLevel("debug");
+    logger->setFile(path);
+    logger->setAsync(8, policy);
+    return logger;
+}
+
+}  // namespace
+
+TEST(LoggerTest, SetAsyncRejectsBadArguments) {
+    Logger logger;
+    EXPECT_THROW(logger.setAsync(8, "fast"), std::invalid_argument);
+    EXPECT_THROW(logger.setAsync(0, "drop"), std::invalid_argument);
+    EXPECT_NO_THROW(logger.setAsync(8, "block"));
+}
+
+// A full queue overruns the oldest messages instead of blocking
+TEST(LoggerTest, DropPolicyCountsOverruns) {
+    StalledLogFile file;
+    auto logger = MakeLogger(file.Path(), "drop");
+
+    const std::string line(1024, 'x');
+    for (int i = 0; i < kMessages; ++i) logger->info(line);
+
+    // The pipe holds ~64 messages and the queue 8; the rest were dropped
+    EXPECT_GT(logger->droppedCount(), static_cast<size_t>(kMessages / 2));
+    EXPECT_EQ(logger->sampledCount(), 0u);
+
+    file.Release();
+    logger.reset();
+}
+
+// Debug messages below the sinks' levels are filtered, not sampled out
+TEST(LoggerTest, SamplePolicyIgnoresFilteredLevels) {
+    StalledLogFile file;
+    auto logger = MakeLogger(file.Path(), "sample");
+    logger->setFileLevel("info");
+    EXPECT_FALSE(logger->should_log(spdlog::level::debug));
+    EXPECT_TRUE(logger->should_log(spdlog::level::info));
+
+    const std::string line(1024, 'x');
+    for (int i = 0; i < kMessages; ++i) logger->info(line);
+    for (int i = 0; i < kMessages; ++i) logger->debug(line);
+    EXPECT_EQ(logger->sampledCount(), 0u);
+
+    file.Release();
+    logger.reset();
+}
+
+// Past half a queue, only every kSampleEvery-th debug message is queued
+TEST(LoggerTest, SamplePolicyThinsDebugMessages) {
+    StalledLogFile file;
+    auto logger = MakeLogger(file.Path(), "sample");
+
+    const std::string line(1024, 'x');
+    for (int i = 0; i < kMessages; ++i) logger->debug(line);
+
+    const size_t sampled = logger->sampledCount();
+    EXPECT_GT(sampled, static_cast<size_t>(kMessages / 2));
+    EXPECT_LT(sampled, static_cast<size_t>(kMessages));
+    EXPECT_GE(logger->droppedCount(), sampled);
+
+    file.Release();
+    logger.reset();
+}
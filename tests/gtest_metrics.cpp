@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics.h"
+
+using bchtree::LatencyHistogram;
+using bchtree::Metrics;
+
+TEST(LatencyHistogramTest, BucketBoundsCoverValue) {
+    for (uint64_t v : {0ull, 1ull, 7ull, 8ull, 15ull, 16ull, 17ull, 1000ull,
+                       123456789ull, (1ull << 40) + 5}) {
+        const size_t idx = LatencyHistogram::BucketIndex(v);
+        ASSERT_LT(idx, LatencyHistogram::kBucketCount);
+        EXPECT_GE(LatencyHistogram::BucketUpperBound(idx), v);
+        if (idx > 0) {
+            EXPECT_LT(LatencyHistogram::BucketUpperBound(idx - 1), v);
+        }
+    }
+}
+
+TEST(LatencyHistogramTest, PercentilesWithinRelativeError) {
+    LatencyHistogram hist;
+    for (uint64_t v = 1; v <= 1000; ++v) {
+        hist.Record(v * 1000);
+    }
+
+    EXPECT_EQ(hist.Count(), 1000u);
+    EXPECT_EQ(hist.Min(), 1000u);
+    EXPECT_EQ(hist.Max(), 1000000u);
+    EXPECT_NEAR(hist.Percentile(50), 500000, 500000 * 0.125);
+    EXPECT_NEAR(hist.Percentile(99), 990000, 990000 * 0.125);
+    EXPECT_EQ(hist.Percentile(100), 1000000u);
+}
+
+TEST(LatencyHistogramTest, ConcurrentRecordCountsAll) {
+    LatencyHistogram hist;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) hist.Record(uint64_t{42});
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    EXPECT_EQ(hist.Count(), 40000u);
+    EXPECT_EQ(hist.Sum(), 40000u * 42);
+}
+
+TEST(MetricsTest, SameKeyReturnsSameHistogram) {
+    Metrics metrics;
+    auto* a = metrics.Get("ca_get_rtt", "TEST:AO");
+    EXPECT_EQ(a, metrics.Get("ca_get_rtt", "TEST:AO"));
+    EXPECT_NE(a, metrics.Get("ca_put_rtt", "TEST:AO"));
+}
+
+TEST(MetricsTest, ExportsJsonAndPrometheus) {
+    Metrics metrics;
+    metrics.Get("tick", "all")->Record(uint64_t{2000});
+    metrics.Get("ca_get_rtt", "TEST:\"AO\"")->Record(uint64_t{5000});
+
+    const std::string json = metrics.ToJson();
+    EXPECT_NE(json.find("\"tick\": {"), std::string::npos);
+    EXPECT_NE(json.find("\"TEST:\\\"AO\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"count\": 1"), std::string::npos);
+
+    const std::string prom = metrics.ToPrometheus();
+    EXPECT_NE(prom.find("# TYPE bchtree_tick_seconds summary"),
+              std::string::npos);
+    EXPECT_NE(
+        prom.find(
+            "bchtree_ca_get_rtt_seconds_count{name=\"TEST:\\\"AO\\\"\"} 1"),
+        std::string::npos);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "trace_recorder.h"
+
+using bchtree::TraceReader;
+using bchtree::TraceRecorder;
+
+class TraceRecorderTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        path_ = (std::filesystem::path(::testing::TempDir()) /
+                 ("bch-trace-" + std::to_string(::getpid()) + ".bin"))
+                    .string();
+    }
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+        std::filesystem::remove(path_ + ".names", ec);
+    }
+
+    std::string path_;
+};
+
+TEST_F(TraceRecorderTest, ReadsBackRecordsInOrder) {
+    {
+        TraceRecorder recorder(path_, 8);
+        recorder.Record(1, 0, 1);
+        recorder.Record(1, 1, 2);
+    }
+
+    TraceReader reader(path_);
+    const auto& recs = reader.Records();
+    ASSERT_EQ(recs.size(), 2u);
+    EXPECT_EQ(recs[0].node_uid, 1);
+    EXPECT_EQ(recs[0].status, 1);
+    EXPECT_EQ(recs[1].prev_status, 1);
+    EXPECT_EQ(recs[1].status, 2);
+    EXPECT_LE(recs[0].timestamp_ns, recs[1].timestamp_ns);
+    EXPECT_GE(recs[0].timestamp_ns, reader.StartNs());
+}
+
+TEST_F(TraceRecorderTest, RingKeepsNewestRecords) {
+    {
+        TraceRecorder recorder(path_, 4);
+        for (uint16_t uid = 0; uid < 10; ++uid) {
+            recorder.Record(uid, 0, 1);
+        }
+    }
+
+    TraceReader reader(path_);
+    const auto& recs = reader.Records();
+    ASSERT_EQ(recs.size(), 4u);
+    for (size_t i = 0; i < recs.size(); ++i) {
+        EXPECT_EQ(recs[i].node_uid, 6 + i);
+    }
+}
+
+TEST_F(TraceRecorderTest, RejectsNonTraceFile) {
+    {
+        std::ofstream ofs(path_);
+        ofs << "not a trace file";
+    }
+    EXPECT_THROW(TraceReader reader(path_), std::runtime_error);
+}
+
+// A capacity whose mapping size would wrap is refused up front
+TEST_F(TraceRecorderTest, RejectsOversizedCapacity) {
+    EXPECT_THROW(TraceRecorder(path_, 0), std::runtime_error);
+    EXPECT_THROW(TraceRecorder(path_, SIZE_MAX), std::runtime_error);
+    EXPECT_THROW(TraceRecorder(path_, SIZE_MAX / sizeof(bchtree::TraceRecord)),
+                 std::runtime_error);
+}
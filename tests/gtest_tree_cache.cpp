@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "actions/print_node.h"
+#include "tree_cache.h"
+
+using namespace bchtree;
+
+namespace {
+
+void WriteFile(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream ofs(path, std::ios::trunc);
+    ofs << text;
+}
+
+std::string SubtreeXml(const std::string& message) {
+    return "<root BTCPP_format=\"4\">\n"
+           "  <BehaviorTree ID=\"Greet\">\n"
+           "    <Print message=\"" +
+           message +
+           "\"/>\n"
+           "  </BehaviorTree>\n"
+           "</root>\n";
+}
+
+}  // namespace
+
+TEST(TreeCacheTest, ReusesParsedTreeUntilIncludeChanges) {
+    const auto dir = std::filesystem::path(::testing::TempDir()) / "cache";
+    std::filesystem::create_directories(dir);
+    const auto main_path = dir / "main.xml";
+    WriteFile(main_path,
+              "<root BTCPP_format=\"4\">\n"
+              "  <include path=\"greet.xml\"/>\n"
+              "  <BehaviorTree ID=\"MainTree\">\n"
+              "    <SubTree ID=\"Greet\"/>\n"
+              "  </BehaviorTree>\n"
+              "</root>\n");
+    WriteFile(dir / "greet.xml", SubtreeXml("hello"));
+
+    TreeCache cache([](BT::BehaviorTreeFactory& factory) {
+        factory.registerNodeType<PrintNode>("Print");
+    });
+
+    auto first = cache.CreateTree(main_path.string(), "MainTree",
+                                  BT::Blackboard::create());
+    auto second = cache.CreateTree(main_path.string(), "MainTree",
+                                   BT::Blackboard::create());
+    EXPECT_EQ(cache.Misses(), 1u);
+    EXPECT_EQ(cache.Hits(), 1u);
+    EXPECT_EQ(second.tickWhileRunning(), BT::NodeStatus::SUCCESS);
+
+    // Editing only the included file invalidates the entry
+    WriteFile(dir / "greet.xml", SubtreeXml("bye"));
+    auto third = cache.CreateTree(main_path.string(), "MainTree",
+                                  BT::Blackboard::create());
+    EXPECT_EQ(cache.Misses(), 2u);
+    EXPECT_EQ(TreeCache::FingerprintOf(main_path.string()).size(), 2u);
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "epics/ca/ca_pv_manager.h"
+#include "softioc_fixture.h"
+#include "tree_supervisor.h"
+
+using namespace bchtree;
+
+namespace {
+
+std::string WriteTree(const std::string& name, const std::string& body) {
+    const auto path =
+        std::filesystem::path(::testing::TempDir()) / (name + ".xml");
+    std::ofstream ofs(path);
+    ofs << "<root BTCPP_format=\"4\">\n"
+           "  <BehaviorTree ID=\"MainTree\">\n"
+           "    <Sequence>\n"
+        << body
+        << "    </Sequence>\n"
+           "  </BehaviorTree>\n"
+           "</root>\n";
+    return path.string();
+}
+
+}  // namespace
+
+TEST_F(SoftIocFixture, TreeSupervisor_SharesChannelsAcrossTrees) {
+    auto pv_manager = std::make_shared<epics::ca::PVManager>(ctx_);
+    TreeSupervisor supervisor(ctx_, pv_manager);
+
+    const std::string body =
+        "      <CAPutDouble pv=\"TEST:AO\" value=\"1.5\" timeout=\"1000\"/>\n"
+        "      <CAGetDouble pv=\"TEST:AO\" timeout=\"1000\" result=\"{v}\"/>\n";
+    supervisor.AddTree(WriteTree("supervisor_a", body));
+    supervisor.AddTree(WriteTree("supervisor_b", body));
+    supervisor.AddTree(WriteTree("supervisor_c", body));
+    supervisor.SetThreadCount(2);
+
+    EXPECT_TRUE(supervisor.RunAll(std::chrono::milliseconds(5)));
+    // All trees used one channel
+    EXPECT_EQ(pv_manager->RegistrySize(), 1u);
+}
+
+TEST_F(SoftIocFixture, TreeSupervisor_BrokenTreeFailsOnlyItself) {
+    auto pv_manager = std::make_shared<epics::ca::PVManager>(ctx_);
+    TreeSupervisor supervisor(ctx_, pv_manager);
+
+    supervisor.AddTree(WriteTree(
+        "supervisor_ok",
+        "      <CAGetDouble pv=\"TEST:AO\" timeout=\"1000\" "
+        "result=\"{v}\"/>\n"));
+    const std::string missing = ::testing::TempDir() + "/does_not_exist.xml";
+    supervisor.AddTree(missing);
+
+    EXPECT_FALSE(supervisor.RunAll(std::chrono::milliseconds(5)));
+    EXPECT_EQ(supervisor.FailedTrees(), std::vector<std::string>{missing});
+}
+
+TEST_F(SoftIocFixture, TreeSupervisor_QualifiesTreeNamesSharingAStem) {
+    auto pv_manager = std::make_shared<epics::ca::PVManager>(ctx_);
+    TreeSupervisor supervisor(ctx_, pv_manager);
+
+    const auto dir = std::filesystem::path(::testing::TempDir());
+    auto& other = supervisor.AddTree((dir / "other.xml").string());
+    auto& a = supervisor.AddTree((dir / "a" / "main.xml").string());
+    EXPECT_EQ(a.TreeName(), "main");
+
+    auto& b = supervisor.AddTree((dir / "b" / "main.xml").string());
+    EXPECT_EQ(a.TreeName(), "a/main");
+    EXPECT_EQ(b.TreeName(), "b/main");
+    EXPECT_EQ(other.TreeName(), "other");
+
+    EXPECT_THROW(supervisor.AddTree((dir / "a" / "main.xml").string()),
+                 std::invalid_argument);
+}
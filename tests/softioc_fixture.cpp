@@ -29,6 +29,34 @@ void SoftIocFixture::SetUpTestSuite() {
                 field(VAL,  "")
                 field(PINI, "YES")
             }
+            record(waveform, "TEST:WF") {
+                field(FTVL, "DOUBLE")
+                field(NELM, "16")
+            }
+            record(bo, "TEST:BO") {
+                field(ZNAM, "Off")
+                field(ONAM, "On")
+                field(PINI, "YES")
+            }
+            record(waveform, "TEST:CHARWF") {
+                field(FTVL, "CHAR")
+                field(NELM, "256")
+            }
+            record(ao, "TEST:AOLIM") {
+                field(EGU,  "mm")
+                field(PREC, "3")
+                field(DRVL, "-10")
+                field(DRVH, "10")
+                field(PINI, "YES")
+            }
+            record(ao, "TEST:SP") {
+                field(VAL,  "0")
+                field(PINI, "YES")
+            }
+            record(ai, "TEST:RBV") {
+                field(INP,  "TEST:SP")
+                field(SCAN, ".1 second")
+            }
         )DB";
 
     runner_.Start(db_text_);